@@ -3,8 +3,85 @@
 #define LED_PIN 11           // PWM pin driving the LCD backlight (matches Nano wiring)
 #define STARTUP_BRIGHTNESS 2 // Initial duty cycle for the backlight
 #define BAUDRATE 57600       // Serial baud rate used for LCDproc bridge
+
+// Runtime baud negotiation (`FC 20 <code>` then `FC 21` at the new rate).
+// If the host does not confirm within the timeout we fall back to BAUDRATE.
+// Lower BAUDRATE_MAX on builds that cannot keep up with faster links.
+#ifndef BAUDRATE_MAX
+#define BAUDRATE_MAX 1000000UL
+#endif
+
+// Build identity reported by the GET_INFO meta reply (`FC 01`). Inject real
+// values per environment via build_flags, e.g. -DARDULCDPP_GIT_SHA=\"abc1234\".
+#ifndef ARDULCDPP_VERSION
+#define ARDULCDPP_VERSION "unknown"
+#endif
+
+#ifndef ARDULCDPP_GIT_SHA
+#define ARDULCDPP_GIT_SHA "unknown"
+#endif
+
+#ifndef ARDULCDPP_ENV
+#define ARDULCDPP_ENV "unknown"
+#endif
+
+#ifndef BAUD_CONFIRM_TIMEOUT_MS
+#define BAUD_CONFIRM_TIMEOUT_MS 1000
+#endif
+
+// Bulk meta ops (`FC 40` region, `FC 50` frame diff, `FC 60` framed region).
+// Their parser state includes an LCDW-byte payload buffer, so the ATmega168
+// leaves them out to keep its SRAM headroom; hosts see `ops=none` in GET_CAPS
+// and fall back to plain HD44780 writes.
+#ifndef ENABLE_REGION_OPS
+#if defined(__AVR_ATmega168__)
+#define ENABLE_REGION_OPS 0
+#else
+#define ENABLE_REGION_OPS 1
+#endif
+#endif
+
+// Panel geometry (override per env, e.g. -DLCDW=16 -DLCDH=4). DDRAM addressing
+// is specialized on these at compile time; see src/display/DdramGeometry.h.
+#ifndef LCDW
 #define LCDW 20              // LCD column count
+#endif
+#ifndef LCDH
 #define LCDH 4               // LCD row count
+#endif
+
+// Model HD44780 display shift (`FE 18`/`FE 1C`, entry mode S=1) in OLED/dual
+// builds with an 80-byte DDRAM shadow. Off by default on the ATmega168 for
+// SRAM; shift commands are then ignored as before (cursor moves still work).
+#ifndef ENABLE_DISPLAY_SHIFT
+#if defined(__AVR_ATmega168__)
+#define ENABLE_DISPLAY_SHIFT 0
+#else
+#define ENABLE_DISPLAY_SHIFT 1
+#endif
+#endif
+
+// Batch consecutive data bytes on one row into a single writeSpan() in the
+// command translator (an LCDW-byte buffer). Off on the ATmega168 for SRAM;
+// bytes then go to the display one write() at a time, as before.
+#ifndef ENABLE_SPAN_BATCHING
+#if defined(__AVR_ATmega168__)
+#define ENABLE_SPAN_BATCHING 0
+#else
+#define ENABLE_SPAN_BATCHING 1
+#endif
+#endif
+
+// Turn OLED clear() into a shadow reset: cells are only blanked at idle if the
+// host did not redraw them, and redrawing a cell with its old content costs no
+// I2C traffic. Needs a LCDW*LCDH text shadow, so it is off on the ATmega168.
+#ifndef ENABLE_LAZY_CLEAR
+#if defined(__AVR_ATmega168__)
+#define ENABLE_LAZY_CLEAR 0
+#else
+#define ENABLE_LAZY_CLEAR 1
+#endif
+#endif
 
 #ifndef ENABLE_SERIAL_DEBUG
 #define ENABLE_SERIAL_DEBUG 0
@@ -26,16 +103,51 @@
 #define ENABLE_DUAL_QUEUE 0
 #endif
 
+// With the dual queue active, only the I2C OLED is deferred by default; the
+// parallel LCD's per-byte cost fits between UART bytes, so it stays
+// write-through. Set to 1 to defer the LCD as well (the pre-split behavior).
+#ifndef DUAL_DEFER_LCD
+#define DUAL_DEFER_LCD 0
+#endif
+
+// Upper bound on how often a deferred sink starts a repaint. Changes made in
+// between are coalesced into the next one, so a host redrawing faster than
+// this does not cost I2C time for frames nobody sees. 0 = uncapped.
+#ifndef DEFERRED_SINK_MAX_REFRESH_HZ
+#define DEFERRED_SINK_MAX_REFRESH_HZ 30
+#endif
+
+// Dual builds can drive a second SSD1306 as a third mux sink; define its I2C
+// address (e.g. -DOLED2_I2C_ADDRESS=0x3D) to enable it.
+#ifndef DISPLAY_MUX_MAX_SINKS
+#ifdef OLED2_I2C_ADDRESS
+#define DISPLAY_MUX_MAX_SINKS 3
+#else
+#define DISPLAY_MUX_MAX_SINKS 2
+#endif
+#endif
+
 // Streaming UX mode:
 // - Immediate: write-through to displays as bytes arrive (best visual immediacy,
 //              may require host pacing to avoid UART overruns on small MCUs).
 // - StreamingSafe: defer display updates during host bursts, then refresh during
 //                  idle (best data integrity for unpaced bursts).
+// - Adaptive: write through until the RX backlog crosses a high-water mark,
+//             then behave like StreamingSafe until it has drained (see the
+//             STREAMING_ADAPTIVE_* thresholds below). Hosts need not choose.
 #define STREAMING_MODE_IMMEDIATE 0
 #define STREAMING_MODE_SAFE 1
+#define STREAMING_MODE_ADAPTIVE 2
 
+// Adaptive everywhere except the ATmega168 dual-queue builds: without lazy
+// clear or the OLED TX queue a single write-through clear there outlasts
+// the 128-byte ring, so they keep the documented StreamingSafe default.
 #ifndef STREAMING_MODE_DEFAULT
+#if defined(__AVR_ATmega168__) && ENABLE_DUAL_QUEUE
 #define STREAMING_MODE_DEFAULT STREAMING_MODE_SAFE
+#else
+#define STREAMING_MODE_DEFAULT STREAMING_MODE_ADAPTIVE
+#endif
 #endif
 
 #ifndef OLED_RESET_PIN
@@ -66,3 +178,69 @@
 #ifndef DISPLAY_BACKEND
 #define DISPLAY_BACKEND HD44780
 #endif
+
+// Put a FrameBufferDisplay (front/back text buffers, cell diff flushed at
+// idle) in front of single-backend builds so identical lcdproc redraws cost no
+// display I/O. On by default for OLED except on the ATmega168, where the
+// front buffer plus the DisplayState text grid (2 x LCDW*LCDH bytes) do not
+// fit next to the rest of its 1 KB SRAM. HD44780 builds may opt in; host
+// commands are then interpreted by the command translator instead of being
+// passed to the controller raw (cursor/blink toggles are lost). Dual builds
+// use ENABLE_DUAL_QUEUE instead.
+#ifndef ENABLE_FRAME_BUFFER
+#if DISPLAY_BACKEND == OLED && !defined(__AVR_ATmega168__)
+#define ENABLE_FRAME_BUFFER 1
+#else
+#define ENABLE_FRAME_BUFFER 0
+#endif
+#endif
+
+// Bind the command translator and frame buffer to the concrete backend types
+// picked above (`src/display/ActiveDisplay.h`) so per-byte calls are direct
+// and inlinable instead of going through the IDisplay vtable. Set to 0 to run
+// everything through IDisplay (e.g., to swap in a test double). DUAL builds
+// keep virtual calls behind the mux, whose sinks are of mixed types.
+#ifndef ENABLE_STATIC_DISPATCH
+#define ENABLE_STATIC_DISPATCH 1
+#endif
+
+// Host RX ring filled by the USART RX ISR (`src/HostSerial.cpp`). Any size
+// from 16 to 256 bytes; one slot stays unused. The ATmega168 only has 1 KB of
+// SRAM, so it gets a shallower ring than the 328P/2560 boards.
+#ifndef SERIAL_RX_RING_SIZE
+#if defined(__AVR_ATmega168__)
+#define SERIAL_RX_RING_SIZE 128
+#else
+#define SERIAL_RX_RING_SIZE 256
+#endif
+#endif
+
+// Adaptive streaming hysteresis, in bytes of RX ring fill: start deferring at
+// the high-water mark, return to write-through at LOW_WATER once deferred
+// sinks have caught up. Unless STREAMING_ADAPTIVE_HIGH_WATER is defined, the
+// high-water mark is derived at boot and on baud changes from the measured
+// row cost: the ring minus the bytes that arrive during one write-through row
+// on every sink (and the refresh reserve).
+#ifndef STREAMING_ADAPTIVE_LOW_WATER
+#define STREAMING_ADAPTIVE_LOW_WATER (SERIAL_RX_RING_SIZE / 16)
+#endif
+
+// OLED cell transmit queue (entries). While a dual build writes through to
+// the OLED (Immediate mode, or Adaptive below its high-water mark), cell
+// writes are queued and sent from the refresh tick within the RX-headroom
+// budget, so the parser is not held up by I2C. Builds on the lazy-clear cell
+// model, so it is 328P/2560-only: ATmega168 dual builds (nano168_dual*) keep
+// it at 0 on purpose, as they have neither lazy clear nor the SRAM. 0 disables.
+#ifndef OLED_TX_QUEUE_SIZE
+#if DISPLAY_BACKEND == DUAL && ENABLE_LAZY_CLEAR
+#define OLED_TX_QUEUE_SIZE 32
+#else
+#define OLED_TX_QUEUE_SIZE 0
+#endif
+#endif
+
+// Upper bound on one I2C transaction (Wire.setWireTimeout). A hung bus is
+// reset and counted instead of stalling the firmware.
+#ifndef OLED_I2C_TIMEOUT_US
+#define OLED_I2C_TIMEOUT_US 5000
+#endif
@@ -27,9 +27,24 @@ import serial
 ESC = 0xFE
 BACKLIGHT = 0xFD
 META_PREFIX = 0xFC
+META_GET_CAPS = 0x02
 META_SET_STREAMING_MODE = 0x10
+META_SET_BAUD = 0x20
+META_CONFIRM_BAUD = 0x21
+META_WRITE_REGION = 0x40
+META_FRAME_UPDATE = 0x50
+META_FRAMED_REGION = 0x60
+FRAME_OP_SKIP = 0x00
+FRAME_OP_COPY = 0x40
+FRAME_OP_REPEAT = 0x80
+FRAME_OP_END = 0xC0
+FRAME_OP_MAX_RUN = 64
 STREAMING_MODE_IMMEDIATE = 0
 STREAMING_MODE_SAFE = 1
+STREAMING_MODE_ADAPTIVE = 2
+
+# Baud codes understood by `FC 20 <code>`.
+LINK_BAUD_CODES = {57600: 0, 115200: 1, 250000: 2, 500000: 3, 1000000: 4}
 
 
 # Custom chars (CGRAM slots 0..7), from the user-provided reference.
@@ -163,11 +178,129 @@ def program_custom_chars(ser: serial.Serial, slot_delay_ms: float) -> None:
             time.sleep(slot_delay_ms / 1000.0)
 
 
-def build_write_at(row: int, col: int, width: int, height: int, data: bytes) -> bytes:
+def build_write_at(row: int, col: int, width: int, height: int, data: bytes, bulk: bool = False) -> bytes:
+    if bulk:
+        # FC 40 <row> <col> <len> <bytes>: one span write on the device.
+        return bytes([META_PREFIX, META_WRITE_REGION, row, col, len(data)]) + data
     addr = ddram_addr_for(row, col, width, height)
     return ddram_set_addr(addr) + data
 
 
+def read_meta_reply(ser: serial.Serial, timeout_s: float = 1.0) -> Optional[bytes]:
+    deadline = time.monotonic() + timeout_s
+    while time.monotonic() < deadline:
+        line = ser.readline()
+        if line.startswith(b"@ARDULCDPP"):
+            return line.strip()
+    return None
+
+
+def negotiate_link_baud(ser: serial.Serial, baud: int) -> bool:
+    """Switch the firmware (and our port) to `baud`; returns False if it stayed at the old rate."""
+    ser.reset_input_buffer()
+    ser.write(bytes([META_PREFIX, META_SET_BAUD, LINK_BAUD_CODES[baud]]))
+    ser.flush()
+    reply = read_meta_reply(ser)
+    if reply is None or not reply.endswith(b" ok"):
+        return False
+    ser.baudrate = baud
+    ser.write(bytes([META_PREFIX, META_CONFIRM_BAUD]))
+    ser.flush()
+    reply = read_meta_reply(ser)
+    return reply is not None and reply.endswith(b" confirmed")
+
+
+def probe_caps(ser: serial.Serial) -> dict:
+    """Ask the firmware for its limits (FC 02); empty on builds that predate it."""
+    ser.reset_input_buffer()
+    ser.write(bytes([META_PREFIX, META_GET_CAPS]))
+    ser.flush()
+    reply = read_meta_reply(ser)
+    if reply is None:
+        return {}
+    caps = {}
+    for field in reply.decode("ascii", "replace").split()[1:]:
+        key, sep, value = field.partition("=")
+        if sep:
+            caps[key] = value
+    return caps
+
+
+def crc8(data: bytes) -> int:
+    """CRC-8, poly 0x07, init 0 (avr-libc `_crc8_ccitt_update`)."""
+    crc = 0
+    for value in data:
+        crc ^= value
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x07) & 0xFF if crc & 0x80 else (crc << 1) & 0xFF
+    return crc
+
+
+def build_framed_region(seq: int, row: int, col: int, data: bytes) -> bytes:
+    body = bytes([seq & 0xFF, row, col, len(data)]) + data
+    return bytes([META_PREFIX, META_FRAMED_REGION]) + body + bytes([crc8(body)])
+
+
+def send_framed_region(ser: serial.Serial, seq: int, row: int, col: int, data: bytes,
+                       retries: int = 3) -> bool:
+    """Send one FC 60 frame, retransmitting it until the device ACKs it."""
+    frame = build_framed_region(seq, row, col, data)
+    expected = f"@ARDULCDPP ack={seq & 0xFF}".encode("ascii")
+    for _ in range(retries + 1):
+        ser.write(frame)
+        ser.flush()
+        if read_meta_reply(ser, timeout_s=0.25) == expected:
+            return True
+    return False
+
+
+def compose_frame(width: int, height: int, segments: Iterable[Tuple[int, int, bytes]]) -> bytes:
+    """Render (row, col, data) segments onto a blank width x height grid (row-major)."""
+    frame = bytearray(b" " * (width * height))
+    for row, col, data in segments:
+        start = row * width + col
+        data = data[: max(0, width - col)]
+        frame[start : start + len(data)] = data
+    return bytes(frame)
+
+
+def encode_frame_update(prev: bytes, cur: bytes) -> bytes:
+    """Encode `cur` as an FC 50 skip/copy/repeat diff against `prev` (what the device shows)."""
+    out = bytearray([META_PREFIX, META_FRAME_UPDATE])
+    n = len(cur)
+    i = 0
+    while i < n:
+        if cur[i] == prev[i]:
+            j = i
+            while j < n and cur[j] == prev[j]:
+                j += 1
+            if j == n:
+                break  # trailing unchanged cells need no ops
+            run = j - i
+            while run:
+                step = min(run, FRAME_OP_MAX_RUN)
+                out.append(FRAME_OP_SKIP | (step - 1))
+                run -= step
+            i = j
+            continue
+        j = i
+        while j < n and j - i < FRAME_OP_MAX_RUN and cur[j] == cur[i]:
+            j += 1
+        if j - i >= 3:
+            out += bytes([FRAME_OP_REPEAT | (j - i - 1), cur[i]])
+            i = j
+            continue
+        j = i
+        while (j < n and j - i < FRAME_OP_MAX_RUN and cur[j] != prev[j]
+               and not (j + 2 < n and cur[j] == cur[j + 1] == cur[j + 2])):
+            j += 1
+        out.append(FRAME_OP_COPY | (j - i - 1))
+        out += cur[i:j]
+        i = j
+    out.append(FRAME_OP_END)
+    return bytes(out)
+
+
 def parse_tz(name: Optional[str]) -> Optional[dt.tzinfo]:
     if not name:
         return None
@@ -183,13 +316,22 @@ def main() -> int:
     parser = argparse.ArgumentParser(description="ArduLCDpp PC clock demo (los-panel over serial).")
     parser.add_argument("--port", default="COM6", help="Serial port (default: COM6)")
     parser.add_argument("--baud", type=int, default=57600, help="Baud rate (default: 57600)")
+    parser.add_argument("--link-baud", type=int, choices=sorted(LINK_BAUD_CODES), default=None,
+                        help="Optional: negotiate a faster link rate after the reset wait (FC 20/FC 21).")
     parser.add_argument("--width", type=int, default=20, help="Display columns (default: 20)")
     parser.add_argument("--height", type=int, default=4, help="Display rows (default: 4)")
     parser.add_argument("--delay", type=float, default=3.0, help="Seconds to wait after opening port (auto-reset).")
     parser.add_argument("--backlight", type=int, default=255, help="Backlight byte 0-255 (default: 255).")
-    parser.add_argument("--streaming", choices=("safe", "immediate"), default=None, help="Optional dual-build mode hint.")
-    parser.add_argument("--slot-delay-ms", type=float, default=15.0, help="Delay between CGRAM slot uploads.")
-    parser.add_argument("--after-clear-ms", type=float, default=10.0, help="Delay after clear/home before DDRAM writes.")
+    parser.add_argument("--streaming", choices=("safe", "immediate", "adaptive"), default=None, help="Optional dual-build mode hint.")
+    parser.add_argument("--slot-delay-ms", type=float, default=None,
+                        help="Delay between CGRAM slot uploads (default: 0 if FC 02 reports a large enough RX buffer, else 15).")
+    parser.add_argument("--after-clear-ms", type=float, default=None,
+                        help="Delay after clear/home before DDRAM writes (default: 0 if FC 02 reports a large enough RX buffer, else 10).")
+    parser.add_argument("--bulk", action="store_true", help="Send row updates as FC 40 region writes.")
+    parser.add_argument("--diff", action="store_true",
+                        help="Send each update as an FC 50 frame diff (--width/--height must match the firmware).")
+    parser.add_argument("--framed", action="store_true",
+                        help="Send row updates as CRC-checked FC 60 frames and retransmit until ACKed.")
     parser.add_argument("--tz", default=None, help="Optional timezone name (e.g., Europe/London).")
     args = parser.parse_args()
 
@@ -209,15 +351,46 @@ def main() -> int:
     last_year: Optional[str] = None
     last_hhmm: Optional[str] = None
     last_colon: Optional[bool] = None
+    last_frame = bytes(b" " * (width * height))  # the device is blank after clear
+    frame_seq = 0
 
     with serial.Serial(args.port, args.baud, timeout=0.1) as ser:
         time.sleep(args.delay)
 
+        if args.link_baud and args.link_baud != args.baud:
+            if negotiate_link_baud(ser, args.link_baud):
+                print(f"link: {args.link_baud} baud")
+            else:
+                # The firmware falls back to its default rate if we never confirmed.
+                ser.baudrate = args.baud
+                time.sleep(1.2)  # outlast BAUD_CONFIRM_TIMEOUT_MS
+                print(f"link: negotiation failed, staying at {args.baud} baud")
+
+        # The init burst (clear + 8 CGRAM slots) is ~90 bytes; if the device can
+        # buffer all of it the fixed pacing delays are unnecessary.
+        caps = probe_caps(ser)
+        rx_buf = int(caps.get("rx_buf", "0") or 0)
+        burst_fits = rx_buf >= 2 + 4 + len(CUST_CHARS) * 10
+        if args.slot_delay_ms is None:
+            args.slot_delay_ms = 0.0 if burst_fits else 15.0
+        if args.after_clear_ms is None:
+            args.after_clear_ms = 0.0 if burst_fits else 10.0
+        if caps:
+            print(f"caps: rx_buf={rx_buf} row_us={caps.get('row_us', '?')}")
+        # ATmega168 builds leave the bulk meta ops out (GET_CAPS `ops=none`).
+        if caps.get("ops") == "none" and (args.bulk or args.diff or args.framed):
+            print("caps: device has no region/frame ops, using plain writes")
+            args.bulk = args.diff = args.framed = False
+
         # Ensure first byte clears the power-on banner promptly.
         init = bytearray()
 
         if args.streaming:
-            mode = STREAMING_MODE_SAFE if args.streaming == "safe" else STREAMING_MODE_IMMEDIATE
+            mode = {
+                "safe": STREAMING_MODE_SAFE,
+                "immediate": STREAMING_MODE_IMMEDIATE,
+                "adaptive": STREAMING_MODE_ADAPTIVE,
+            }[args.streaming]
             init += bytes([META_PREFIX, META_SET_STREAMING_MODE, mode])
 
         level = max(0, min(255, int(args.backlight)))
@@ -242,22 +415,43 @@ def main() -> int:
             colon_on = (now.second % 2) == 0
 
             buf = bytearray()
+            segments: List[Tuple[int, int, bytes]] = []
 
             if date_str != last_date:
-                buf += build_write_at(0, 0, width, height, pad_or_trim(date_str, width))
+                segments.append((0, 0, pad_or_trim(date_str, width)))
                 last_date = date_str
 
             if year_str != last_year:
-                buf += build_write_at(3, max(0, width - 4), width, height, year_str.encode("ascii"))
+                segments.append((3, max(0, width - 4), year_str.encode("ascii")))
                 last_year = year_str
 
             if (hhmm != last_hhmm) or (colon_on != last_colon):
                 top, bottom = render_big_time(hhmm, colon_on)
-                buf += build_write_at(1, time_start_col, width, height, top)
-                buf += build_write_at(2, time_start_col, width, height, bottom)
+                segments.append((1, time_start_col, top))
+                segments.append((2, time_start_col, bottom))
                 last_hhmm = hhmm
                 last_colon = colon_on
 
+            if args.diff:
+                top, bottom = render_big_time(hhmm, colon_on)
+                frame = compose_frame(width, height, (
+                    (0, 0, pad_or_trim(date_str, width)),
+                    (1, time_start_col, top),
+                    (2, time_start_col, bottom),
+                    (3, max(0, width - 4), year_str.encode("ascii")),
+                ))
+                if frame != last_frame:
+                    buf += encode_frame_update(last_frame, frame)
+                    last_frame = frame
+            elif args.framed:
+                for row, col, data in segments:
+                    if not send_framed_region(ser, frame_seq, row, col, data):
+                        print(f"link: row {row} not acknowledged (seq {frame_seq & 0xFF})")
+                    frame_seq += 1
+            else:
+                for row, col, data in segments:
+                    buf += build_write_at(row, col, width, height, data, args.bulk)
+
             if buf:
                 ser.write(buf)
                 ser.flush()
@@ -22,8 +22,11 @@ PRINTABLE_BASE = 0x20
 PRINTABLE_RANGE = 0x5F  # 0x20-0x7E inclusive
 META_PREFIX = 0xFC
 META_SET_STREAMING_MODE = 0x10
+META_SET_FLOW_CONTROL = 0x30
+CREDIT_REPLY_PREFIX = "@ARDULCDPP credit="
 STREAMING_MODE_IMMEDIATE = 0
 STREAMING_MODE_SAFE = 1
+STREAMING_MODE_ADAPTIVE = 2
 
 
 def build_t4_payload(fill_byte: int = 0x5A) -> bytes:
@@ -65,27 +68,69 @@ def build_streaming_mode_payload(mode: str) -> bytes:
 		mode_value = STREAMING_MODE_IMMEDIATE
 	elif mode_lower == "safe":
 		mode_value = STREAMING_MODE_SAFE
+	elif mode_lower == "adaptive":
+		mode_value = STREAMING_MODE_ADAPTIVE
 	else:
 		raise ValueError(f"Unknown streaming mode: {mode}")
 	return bytes([META_PREFIX, META_SET_STREAMING_MODE, mode_value])
 
 
+class CreditGate:
+	"""Byte credit granted by the firmware (`FC 30 01` flow control)."""
+
+	def __init__(self) -> None:
+		self._credit = 0
+		self._cond = threading.Condition()
+
+	def grant(self, amount: int) -> None:
+		with self._cond:
+			self._credit += amount
+			self._cond.notify_all()
+
+	def take(self, wanted: int, timeout: float) -> int:
+		"""Block until some credit is available; return how many bytes we may send."""
+		with self._cond:
+			if not self._cond.wait_for(lambda: self._credit > 0, timeout):
+				return 0
+			granted = min(wanted, self._credit)
+			self._credit -= granted
+			return granted
+
+
 def reader_thread(test_name: str, ser: serial.Serial, stop_event: threading.Event,
-                  sink: List[str]) -> None:
+                  sink: List[str], gate: Optional[CreditGate] = None) -> None:
 	"""Continuously read lines from Serial and stash them in sink."""
 	prefix = f"[{test_name}]"
 	while not stop_event.is_set():
 		line = ser.readline()
 		if line:
 			decoded = line.decode("utf-8", errors="replace").rstrip()
+			if gate is not None and decoded.startswith(CREDIT_REPLY_PREFIX):
+				gate.grant(int(decoded[len(CREDIT_REPLY_PREFIX):]))
+				continue
 			print(decoded)
 			sink.append(decoded)
 		else:
 			time.sleep(0.01)
 
 
+def send_with_credit(ser: serial.Serial, gate: CreditGate, payload: bytes,
+                     timeout: float = 2.0) -> bool:
+	"""Stream payload at full line rate, never exceeding the granted credit."""
+	offset = 0
+	while offset < len(payload):
+		granted = gate.take(len(payload) - offset, timeout)
+		if granted == 0:
+			return False
+		ser.write(payload[offset:offset + granted])
+		offset += granted
+	ser.flush()
+	return True
+
+
 def run(test_name: str, port: str, delay_before_send: float,
-        capture_duration: float, fill_byte: int, streaming_mode: Optional[str]) -> int:
+        capture_duration: float, fill_byte: int, streaming_mode: Optional[str],
+        flow: Optional[str] = None) -> int:
 	builder = build_t4_payload if test_name.upper() == "T4" else build_t8_payload
 	payload = builder(fill_byte)
 	prefix = f"[{test_name.upper()}]"
@@ -96,8 +141,9 @@ def run(test_name: str, port: str, delay_before_send: float,
 		time.sleep(delay_before_send)
 		stop_event = threading.Event()
 		logs: List[str] = []
+		gate = CreditGate() if flow == "credit" else None
 		reader = threading.Thread(
-		    target=reader_thread, args=(test_name.upper(), ser, stop_event, logs), daemon=True
+		    target=reader_thread, args=(test_name.upper(), ser, stop_event, logs, gate), daemon=True
 		)
 		reader.start()
 		try:
@@ -109,8 +155,14 @@ def run(test_name: str, port: str, delay_before_send: float,
 				time.sleep(0.05)
 
 			print(f"{prefix} sending {len(payload)} bytes (fill=0x{fill_byte:02X})")
-			ser.write(payload)
-			ser.flush()
+			if gate is not None:
+				ser.write(bytes([META_PREFIX, META_SET_FLOW_CONTROL, 1]))
+				ser.flush()
+				if not send_with_credit(ser, gate, payload):
+					print(f"{prefix} WARNING: timed out waiting for flow-control credit.")
+			else:
+				ser.write(payload)
+				ser.flush()
 			print(f"{prefix} capture window {capture_duration:.1f}s...")
 			time.sleep(capture_duration)
 		finally:
@@ -144,11 +196,14 @@ def main() -> int:
 	                    help="Data byte used for generated payloads (default: 0x5A)")
 	parser.add_argument("--test", choices=("t4", "t8"), default="t4",
 	                    help="Which smoke-test payload to send (default: t4)")
-	parser.add_argument("--streaming", choices=("safe", "immediate"),
+	parser.add_argument("--streaming", choices=("safe", "immediate", "adaptive"),
 	                    help="Optional: send FC 10 <mode> before the payload")
+	parser.add_argument("--flow", choices=("credit",),
+	                    help="Optional: enable FC 30 01 credit flow control and stream at full rate")
 	args = parser.parse_args()
 	try:
-		return run(args.test, args.port, args.delay, args.capture, args.fill, args.streaming)
+		return run(args.test, args.port, args.delay, args.capture, args.fill, args.streaming,
+		           args.flow)
 	except serial.SerialException as exc:
 		prefix = f"[{args.test.upper()}]"
 		sys.stderr.write(f"{prefix} Serial error: {exc}\n")
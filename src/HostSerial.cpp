@@ -0,0 +1,149 @@
+#include "HostSerial.h"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+
+static_assert(SERIAL_RX_RING_SIZE >= 16 && SERIAL_RX_RING_SIZE <= 256,
+              "SERIAL_RX_RING_SIZE must be between 16 and 256 bytes");
+
+HostSerialPort HostSerial;
+
+namespace {
+// One slot stays empty so head == tail always means "empty". Indices wrap by
+// compare rather than mask so the ring can take whatever SRAM the build has
+// left (e.g. 192 bytes), not just a power of two.
+inline uint8_t ringNext(uint8_t index) {
+	return (index + 1 == SERIAL_RX_RING_SIZE) ? 0 : static_cast<uint8_t>(index + 1);
+}
+
+inline uint8_t ringFill(uint8_t head, uint8_t tail) {
+	return head >= tail ? static_cast<uint8_t>(head - tail)
+	                    : static_cast<uint8_t>(SERIAL_RX_RING_SIZE - tail + head);
+}
+
+volatile uint8_t rx_ring[SERIAL_RX_RING_SIZE];
+volatile uint8_t rx_head = 0;
+volatile uint8_t rx_tail = 0;
+
+volatile uint32_t rx_bytes_received = 0;
+volatile uint16_t rx_dropped = 0;
+volatile uint16_t rx_overruns = 0;
+volatile uint16_t rx_framing_errors = 0;
+volatile uint16_t rx_high_water = 0;
+
+inline void handleRxInterrupt() {
+	const uint8_t status = UCSR0A;
+	const uint8_t value = UDR0;
+	if (status & _BV(DOR0)) {
+		++rx_overruns;
+	}
+	if (status & _BV(FE0)) {
+		++rx_framing_errors;
+	}
+	++rx_bytes_received;
+
+	const uint8_t head = rx_head;
+	const uint8_t next = ringNext(head);
+	if (next == rx_tail) {
+		++rx_dropped;
+		return;
+	}
+	rx_ring[head] = value;
+	rx_head = next;
+
+	const uint8_t fill = ringFill(next, rx_tail);
+	if (fill > rx_high_water) {
+		rx_high_water = fill;
+	}
+}
+} // namespace
+
+#if defined(USART_RX_vect)
+ISR(USART_RX_vect) {
+	handleRxInterrupt();
+}
+#elif defined(USART0_RX_vect)
+ISR(USART0_RX_vect) {
+	handleRxInterrupt();
+}
+#else
+#error "HostSerial: no USART0 RX vector for this MCU."
+#endif
+
+void HostSerialPort::begin(uint32_t baud) {
+	// Same divisor rules as HardwareSerial::begin(): prefer U2X, except for
+	// 57600 @ 16 MHz where the classic bootloaders expect the 1x setting.
+	uint16_t setting = static_cast<uint16_t>((F_CPU / 4 / baud - 1) / 2);
+	bool double_speed = true;
+	if ((F_CPU == 16000000UL && baud == 57600) || setting > 4095) {
+		setting = static_cast<uint16_t>((F_CPU / 8 / baud - 1) / 2);
+		double_speed = false;
+	}
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		UCSR0B = 0;
+		UCSR0A = double_speed ? _BV(U2X0) : 0;
+		UBRR0H = static_cast<uint8_t>(setting >> 8);
+		UBRR0L = static_cast<uint8_t>(setting);
+		UCSR0C = _BV(UCSZ01) | _BV(UCSZ00); // 8-N-1
+		rx_head = 0;
+		rx_tail = 0;
+		UCSR0B = _BV(RXEN0) | _BV(TXEN0) | _BV(RXCIE0);
+	}
+	baud_ = baud;
+	tx_pending_ = false;
+}
+
+uint32_t HostSerialPort::baud() const {
+	return baud_;
+}
+
+int HostSerialPort::available() const {
+	return ringFill(rx_head, rx_tail);
+}
+
+int HostSerialPort::read() {
+	const uint8_t tail = rx_tail;
+	if (tail == rx_head) {
+		return -1;
+	}
+	const uint8_t value = rx_ring[tail];
+	rx_tail = ringNext(tail);
+	return value;
+}
+
+size_t HostSerialPort::write(uint8_t value) {
+	while (!(UCSR0A & _BV(UDRE0))) {
+	}
+	// Clear TXC (write-one-to-clear) so flush() can wait for this byte; keep U2X.
+	UCSR0A = static_cast<uint8_t>((UCSR0A & (_BV(U2X0) | _BV(MPCM0))) | _BV(TXC0));
+	UDR0 = value;
+	tx_pending_ = true;
+	return 1;
+}
+
+void HostSerialPort::flush() {
+	if (!tx_pending_) {
+		return;
+	}
+	while (!(UCSR0A & _BV(TXC0))) {
+	}
+	tx_pending_ = false;
+}
+
+uint16_t HostSerialPort::capacity() const {
+	return static_cast<uint16_t>(SERIAL_RX_RING_SIZE - 1);
+}
+
+HostSerialPort::Stats HostSerialPort::stats() const {
+	Stats snapshot;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		snapshot.bytes_received = rx_bytes_received;
+		snapshot.dropped = rx_dropped;
+		snapshot.overruns = rx_overruns;
+		snapshot.framing_errors = rx_framing_errors;
+		snapshot.high_water = rx_high_water;
+	}
+	return snapshot;
+}
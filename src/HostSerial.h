@@ -0,0 +1,38 @@
+#pragma once
+
+#include <Arduino.h>
+#include <DisplayConfig.h>
+
+// Host link on USART0. Replaces HardwareSerial so the RX side can use a
+// dedicated ISR feeding a per-board ring (`SERIAL_RX_RING_SIZE`) and account
+// for every byte it had to drop. TX stays polled: diagnostics are idle-gated,
+// and the RX ISR keeps draining the line while we spin on UDRE.
+class HostSerialPort : public Print {
+public:
+	struct Stats {
+		uint32_t bytes_received; // bytes accepted from the UART (including dropped ones)
+		uint16_t dropped;        // bytes discarded because the ring was full
+		uint16_t overruns;       // hardware DOR events (byte lost before the ISR ran)
+		uint16_t framing_errors; // FE events (usually a baud mismatch)
+		uint16_t high_water;     // deepest ring fill observed by the ISR
+	};
+
+	// Safe to call again at runtime to switch rates (the RX ring is reset).
+	void begin(uint32_t baud);
+	uint32_t baud() const;
+	int available() const;
+	int read();
+	size_t write(uint8_t value) override;
+	using Print::write;
+	// Block until every queued TX bit has left the shift register.
+	void flush();
+
+	uint16_t capacity() const;
+	Stats stats() const;
+
+private:
+	uint32_t baud_ = 0;
+	bool tx_pending_ = false;
+};
+
+extern HostSerialPort HostSerial;
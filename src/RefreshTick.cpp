@@ -0,0 +1,51 @@
+#include "RefreshTick.h"
+
+#include <avr/interrupt.h>
+#include <avr/io.h>
+#include <util/atomic.h>
+
+RefreshTickTimer RefreshTick;
+
+namespace {
+volatile uint8_t pending_ticks = 0;
+volatile uint16_t tick_count = 0;
+} // namespace
+
+ISR(TIMER0_COMPB_vect) {
+	++tick_count;
+	if (pending_ticks != 0xFF) {
+		++pending_ticks;
+	}
+}
+
+void RefreshTickTimer::begin() {
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		// Half-way through the count so the tick does not stack on the
+		// millis() overflow interrupt. OC0B stays disconnected from D5 unless
+		// analogWrite() claims it, and the LCD uses D5 as a plain data pin.
+		OCR0B = 0x80;
+		pending_ticks = 0;
+		TIMSK0 |= _BV(OCIE0B);
+	}
+}
+
+bool RefreshTickTimer::due() const {
+	return pending_ticks != 0;
+}
+
+uint8_t RefreshTickTimer::take() {
+	uint8_t ticks;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		ticks = pending_ticks;
+		pending_ticks = 0;
+	}
+	return ticks;
+}
+
+uint16_t RefreshTickTimer::now() const {
+	uint16_t ticks;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		ticks = tick_count;
+	}
+	return ticks;
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <Arduino.h>
+#include <DisplayConfig.h>
+
+// Fixed-cadence tick for the display-refresh scheduler. Piggybacks on Timer0
+// (already free-running for millis()) via its compare-B interrupt, so it
+// fires once per Timer0 overflow period (1.024 ms at 16 MHz) without
+// touching Timer2, which drives the backlight PWM on D11. The ISR only
+// counts; the refresh work itself runs in loop() context because I2C/LCD
+// writes cannot run inside an interrupt.
+class RefreshTickTimer {
+public:
+	void begin();
+	// True once at least one tick has fired since the last take().
+	bool due() const;
+	// Number of ticks since the last take() (saturating), and clear them.
+	uint8_t take();
+	// Free-running tick count, for timestamps in tick units.
+	uint16_t now() const;
+};
+
+extern RefreshTickTimer RefreshTick;
@@ -3,15 +3,17 @@
 #include <Arduino.h>
 #include <DisplayConfig.h>
 
+#include "HostSerial.h"
+
 namespace SerialDebug {
 #if ENABLE_SERIAL_DEBUG
 void setRuntimeEnabled(bool enabled);
 bool isRuntimeEnabled();
 
 inline void printPrefix() {
-	Serial.print(F("debug:"));
-	Serial.print(micros());
-	Serial.print(F("us "));
+	HostSerial.print(F("debug:"));
+	HostSerial.print(micros());
+	HostSerial.print(F("us "));
 }
 
 inline void line(bool enabled, const __FlashStringHelper *message) {
@@ -19,7 +21,7 @@ inline void line(bool enabled, const __FlashStringHelper *message) {
 		return;
 	}
 	printPrefix();
-	Serial.println(message);
+	HostSerial.println(message);
 }
 
 inline void line(bool enabled, const char *message) {
@@ -27,7 +29,7 @@ inline void line(bool enabled, const char *message) {
 		return;
 	}
 	printPrefix();
-	Serial.println(message);
+	HostSerial.println(message);
 }
 
 template <typename TValue>
@@ -36,9 +38,9 @@ inline void kv(bool enabled, const __FlashStringHelper *key, const TValue &value
 		return;
 	}
 	printPrefix();
-	Serial.print(key);
-	Serial.print(F("="));
-	Serial.println(value);
+	HostSerial.print(key);
+	HostSerial.print(F("="));
+	HostSerial.println(value);
 }
 
 template <typename TValue>
@@ -47,9 +49,9 @@ inline void kv(bool enabled, const char *key, const TValue &value) {
 		return;
 	}
 	printPrefix();
-	Serial.print(key);
-	Serial.print(F("="));
-	Serial.println(value);
+	HostSerial.print(key);
+	HostSerial.print(F("="));
+	HostSerial.println(value);
 }
 #else
 inline void setRuntimeEnabled(bool) {}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <DisplayConfig.h>
+
+#include "display/FrameBufferDisplay.h"
+#include "display/IDisplay.h"
+
+#if ENABLE_STATIC_DISPATCH && DISPLAY_BACKEND == HD44780
+#include "display/HD44780Display.h"
+#elif ENABLE_STATIC_DISPATCH && DISPLAY_BACKEND == OLED
+#include "display/OLEDDisplay.h"
+#elif ENABLE_STATIC_DISPATCH && DISPLAY_BACKEND == DUAL
+#include "display/DisplayMux.h"
+#endif
+
+// Compile-time choice of display types for this build. PanelDisplay is the
+// single physical backend (what a frame buffer wraps); ActiveDisplay is the
+// outermost display that main.cpp and the command translator talk to.
+// Without ENABLE_STATIC_DISPATCH both are plain IDisplay.
+#if ENABLE_STATIC_DISPATCH && DISPLAY_BACKEND == HD44780
+using PanelDisplay = HD44780Display;
+#elif ENABLE_STATIC_DISPATCH && DISPLAY_BACKEND == OLED
+using PanelDisplay = OLEDDisplay;
+#else
+using PanelDisplay = IDisplay;
+#endif
+
+#if ENABLE_FRAME_BUFFER
+using FrameBufferDisplay = BasicFrameBufferDisplay<PanelDisplay>;
+#endif
+
+#if !ENABLE_STATIC_DISPATCH
+using ActiveDisplay = IDisplay;
+#elif ENABLE_FRAME_BUFFER
+using ActiveDisplay = FrameBufferDisplay;
+#elif DISPLAY_BACKEND == DUAL
+using ActiveDisplay = DisplayMux;
+#else
+using ActiveDisplay = PanelDisplay;
+#endif
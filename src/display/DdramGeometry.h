@@ -0,0 +1,75 @@
+#pragma once
+
+#include <DisplayConfig.h>
+#include <avr/pgmspace.h>
+#include <stdint.h>
+
+// HD44780 DDRAM layout for a fixed panel size. Rows 0/1 start at 0x00/0x40 and
+// rows 2/3 continue those lines at +Width (0x14/0x54 on 20x4, 0x10/0x50 on
+// 16x4). Decoding an address is a single PROGMEM lookup instead of a scan over
+// row bases, and everything else folds to constants per build.
+template <uint8_t Width, uint8_t Height>
+struct DdramGeometry {
+	static_assert(Height >= 1 && Height <= 4, "DdramGeometry: 1-4 rows supported");
+	static_assert(Width >= 1 && Width <= 40, "DdramGeometry: at most 40 columns per DDRAM line");
+	static_assert(Height <= 2 || Width <= 32, "DdramGeometry: rows 2/3 must fit after rows 0/1 in a 64-byte line");
+
+	static constexpr uint8_t kWidth = Width;
+	static constexpr uint8_t kHeight = Height;
+	static constexpr uint16_t kCells = static_cast<uint16_t>(Width) * Height;
+
+	static constexpr uint8_t rowBase(uint8_t row) {
+		return static_cast<uint8_t>(((row & 0x01) ? 0x40 : 0x00) + ((row & 0x02) ? Width : 0));
+	}
+
+	// Column overflow maps to 0x00 and rows wrap, matching the old runtime helper.
+	static constexpr uint8_t encode(uint8_t row, uint8_t column) {
+		return column >= Width ? 0 : static_cast<uint8_t>(rowBase(static_cast<uint8_t>(row % Height)) + column);
+	}
+
+	static bool decode(uint8_t address, uint8_t &row, uint8_t &column) {
+		const uint8_t entry = pgm_read_byte(&kDecodeTable[address & 0x7F]);
+		if (entry == kInvalid) {
+			return false;
+		}
+		row = static_cast<uint8_t>(entry >> 6);
+		column = static_cast<uint8_t>(entry & 0x3F);
+		return true;
+	}
+
+	// Table entries pack (row << 6) | column; 0xFF (column 63) is never valid.
+	static constexpr uint8_t kInvalid = 0xFF;
+
+	static constexpr uint8_t decodeEntry(uint8_t address, uint8_t row = 0) {
+		return row >= Height ? kInvalid
+		       : (address >= rowBase(row) && address < rowBase(row) + Width)
+		             ? static_cast<uint8_t>((row << 6) | (address - rowBase(row)))
+		             : decodeEntry(address, static_cast<uint8_t>(row + 1));
+	}
+
+	static const uint8_t kDecodeTable[128];
+};
+
+template <uint8_t Width, uint8_t Height>
+constexpr uint8_t DdramGeometry<Width, Height>::kWidth;
+template <uint8_t Width, uint8_t Height>
+constexpr uint8_t DdramGeometry<Width, Height>::kHeight;
+template <uint8_t Width, uint8_t Height>
+constexpr uint16_t DdramGeometry<Width, Height>::kCells;
+template <uint8_t Width, uint8_t Height>
+constexpr uint8_t DdramGeometry<Width, Height>::kInvalid;
+
+#define DDRAM_DECODE_4(a) decodeEntry(a), decodeEntry((a) + 1), decodeEntry((a) + 2), decodeEntry((a) + 3)
+#define DDRAM_DECODE_16(a) DDRAM_DECODE_4(a), DDRAM_DECODE_4((a) + 4), DDRAM_DECODE_4((a) + 8), DDRAM_DECODE_4((a) + 12)
+
+template <uint8_t Width, uint8_t Height>
+const uint8_t DdramGeometry<Width, Height>::kDecodeTable[128] PROGMEM = {
+    DDRAM_DECODE_16(0x00), DDRAM_DECODE_16(0x10), DDRAM_DECODE_16(0x20), DDRAM_DECODE_16(0x30),
+    DDRAM_DECODE_16(0x40), DDRAM_DECODE_16(0x50), DDRAM_DECODE_16(0x60), DDRAM_DECODE_16(0x70),
+};
+
+#undef DDRAM_DECODE_16
+#undef DDRAM_DECODE_4
+
+// Geometry of the panel this firmware is built for.
+using PanelGeometry = DdramGeometry<LCDW, LCDH>;
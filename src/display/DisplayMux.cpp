@@ -0,0 +1,529 @@
+#include "display/DisplayMux.h"
+
+#include <Arduino.h>
+#include <DisplayConfig.h>
+#include <string.h>
+
+#include "HostSerial.h"
+#include "RefreshTick.h"
+#include "SerialDebug.h"
+
+#if ENABLE_DUAL_DEBUG
+#define DUAL_DEBUG(msg) SerialDebug::line(true, F(msg))
+#else
+#define DUAL_DEBUG(msg) do {} while (0)
+#endif
+
+#if ENABLE_DUAL_QUEUE
+namespace {
+// A dirty row older than this many refresh ticks goes ahead of newer changes.
+constexpr uint8_t kMaxRowAgeTicks = 64;
+}
+#endif
+
+DisplayMux::DisplayMux(DisplayState &state)
+    : state_(state) {}
+
+bool DisplayMux::addSink(IDisplay &display, SinkPolicy policy, uint16_t minRefreshTicks) {
+	if (sink_count_ >= DISPLAY_MUX_MAX_SINKS) {
+		return false;
+	}
+	Sink &sink = sinks_[sink_count_++];
+	sink.display = &display;
+#if ENABLE_DUAL_QUEUE
+	sink.policy = policy;
+	sink.cell_us = 1;
+	sink.min_refresh_ticks = minRefreshTicks;
+	sink.last_refresh_tick = 0;
+	sink.dirty_rows = 0;
+	sink.overdue_rows = 0;
+	sink.cgram_dirty = 0;
+	sink.refreshing = false;
+#else
+	(void)policy;
+	(void)minRefreshTicks;
+#endif
+	return true;
+}
+
+uint8_t DisplayMux::sinkCount() const {
+	return sink_count_;
+}
+
+IDisplay &DisplayMux::sink(uint8_t index) {
+	return *sinks_[index < sink_count_ ? index : 0].display;
+}
+
+void DisplayMux::setRowCostUs(uint8_t index, uint32_t rowUs) {
+#if ENABLE_DUAL_QUEUE
+	if (index >= sink_count_) {
+		return;
+	}
+	const uint32_t cell = rowUs / PanelGeometry::kWidth;
+	sinks_[index].cell_us = static_cast<uint16_t>(cell == 0 ? 1 : cell > 0xFFFF ? 0xFFFF : cell);
+#else
+	(void)index;
+	(void)rowUs;
+#endif
+}
+
+void DisplayMux::begin(uint8_t width, uint8_t height) {
+	HostSerial.print(F("ENABLE_DUAL_DEBUG:"));
+	HostSerial.println(ENABLE_DUAL_DEBUG);
+
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+		HostSerial.print(F("dual: begin sink "));
+		HostSerial.println(i);
+		sinks_[i].display->begin(width, height);
+#if ENABLE_DUAL_QUEUE
+		sinks_[i].dirty_rows = 0;
+		sinks_[i].overdue_rows = 0;
+		sinks_[i].cgram_dirty = 0;
+		sinks_[i].refreshing = false;
+#endif
+	}
+	HostSerial.println(F("dual: begin sinks done"));
+
+#if ENABLE_DUAL_QUEUE
+	cursor_column_ = 0;
+	cursor_row_ = 0;
+	memset(state_.text, ' ', sizeof(state_.text));
+	memset(state_.glyphs, 0, sizeof(state_.glyphs));
+#endif
+
+	DUAL_DEBUG("DisplayMux: begin complete");
+}
+
+void DisplayMux::clear() {
+	DUAL_DEBUG("DisplayMux: clear");
+#if ENABLE_DUAL_QUEUE
+	cursor_column_ = 0;
+	cursor_row_ = 0;
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+		Sink &sink = sinks_[i];
+		if (!deferred(sink)) {
+			sink.display->clear();
+			continue;
+		}
+		// Deferred sinks are blanked at idle, and only the non-blank stretch of
+		// each row needs it.
+		for (uint8_t row = 0; row < PanelGeometry::kHeight; ++row) {
+			const uint8_t *cells = state_.row(row);
+			uint8_t first = 0;
+			while (first < PanelGeometry::kWidth && cells[first] == ' ') {
+				++first;
+			}
+			if (first == PanelGeometry::kWidth) {
+				continue;
+			}
+			uint8_t last = PanelGeometry::kWidth - 1;
+			while (cells[last] == ' ') {
+				--last;
+			}
+			markDirty(sink, row, first, last);
+		}
+	}
+	memset(state_.text, ' ', sizeof(state_.text));
+#else
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+		sinks_[i].display->clear();
+	}
+#endif
+#if ENABLE_SERIAL_DEBUG
+	if (SerialDebug::isRuntimeEnabled()) {
+		SerialDebug::printPrefix();
+		HostSerial.println(F("dual: clear done"));
+	}
+#endif
+}
+
+void DisplayMux::home() {
+#if ENABLE_DUAL_QUEUE
+	cursor_column_ = 0;
+	cursor_row_ = 0;
+#endif
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+#if ENABLE_DUAL_QUEUE
+		if (deferred(sinks_[i])) {
+			continue;
+		}
+#endif
+		sinks_[i].display->home();
+	}
+}
+
+void DisplayMux::display() {
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+#if ENABLE_DUAL_QUEUE
+		if (deferred(sinks_[i])) {
+			continue;
+		}
+#endif
+		sinks_[i].display->display();
+	}
+}
+
+void DisplayMux::setCursor(uint8_t column, uint8_t row) {
+#if ENABLE_DUAL_QUEUE
+	cursor_column_ = column;
+	cursor_row_ = row;
+#endif
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+#if ENABLE_DUAL_QUEUE
+		if (deferred(sinks_[i])) {
+			continue;
+		}
+#endif
+		sinks_[i].display->setCursor(column, row);
+	}
+}
+
+size_t DisplayMux::write(uint8_t value) {
+#if !ENABLE_DUAL_QUEUE
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+		sinks_[i].display->write(value);
+	}
+	return 1;
+#else
+	const bool in_frame = cursor_row_ < PanelGeometry::kHeight && cursor_column_ < PanelGeometry::kWidth;
+	if (in_frame) {
+		state_.row(cursor_row_)[cursor_column_] = value;
+	}
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+		Sink &sink = sinks_[i];
+		if (!deferred(sink)) {
+			sink.display->write(value);
+		} else if (in_frame) {
+			markDirty(sink, cursor_row_, cursor_column_, cursor_column_);
+		}
+	}
+	// Advance a simple cursor model for callers that write strings without
+	// re-positioning each byte (e.g., the startup banner).
+	++cursor_column_;
+	if (cursor_column_ >= PanelGeometry::kWidth) {
+		cursor_column_ = 0;
+		cursor_row_ = static_cast<uint8_t>((cursor_row_ + 1) % PanelGeometry::kHeight);
+	}
+	return 1;
+#endif
+}
+
+size_t DisplayMux::writeSpan(uint8_t column, uint8_t row, const uint8_t *data, uint8_t length) {
+#if !ENABLE_DUAL_QUEUE
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+		sinks_[i].display->writeSpan(column, row, data, length);
+	}
+	return length;
+#else
+	uint8_t count = 0;
+	if (row < PanelGeometry::kHeight && column < PanelGeometry::kWidth) {
+		const uint8_t room = static_cast<uint8_t>(PanelGeometry::kWidth - column);
+		count = length < room ? length : room;
+		memcpy(state_.row(row) + column, data, count);
+	}
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+		Sink &sink = sinks_[i];
+		if (!deferred(sink)) {
+			sink.display->writeSpan(column, row, data, length);
+		} else if (count > 0) {
+			markDirty(sink, row, column, static_cast<uint8_t>(column + count - 1));
+		}
+	}
+	// Leave the cursor model where per-byte writes would have left it.
+	const uint16_t end = static_cast<uint16_t>(column) + length;
+	if (end >= PanelGeometry::kWidth) {
+		cursor_column_ = 0;
+		cursor_row_ = static_cast<uint8_t>((row + 1) % PanelGeometry::kHeight);
+	} else {
+		cursor_column_ = static_cast<uint8_t>(end);
+		cursor_row_ = row;
+	}
+	return length;
+#endif
+}
+
+void DisplayMux::createChar(uint8_t slot, const uint8_t bitmap[8]) {
+#if ENABLE_DUAL_QUEUE
+	// Deferred sinks get the latest bitmap per slot at idle, before their rows
+	// are repainted, so glyph-based dashboards stay in parity.
+	const bool cached = slot < 8 && bitmap;
+	// The translator stages uploads in the shared glyph bank already.
+	if (cached && bitmap != state_.glyphs[slot]) {
+		memcpy(state_.glyphs[slot], bitmap, 8);
+	}
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+		Sink &sink = sinks_[i];
+		if (!deferred(sink)) {
+			sink.display->createChar(slot, bitmap);
+			if (cached) {
+				sink.cgram_dirty &= static_cast<uint8_t>(~(1U << slot));
+			}
+		} else if (cached) {
+			sink.cgram_dirty |= static_cast<uint8_t>(1U << slot);
+		}
+	}
+#else
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+		sinks_[i].display->createChar(slot, bitmap);
+	}
+#endif
+}
+
+void DisplayMux::command(uint8_t value) {
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+#if ENABLE_DUAL_QUEUE
+		if (deferred(sinks_[i])) {
+			continue;
+		}
+#endif
+		sinks_[i].display->command(value);
+	}
+}
+
+void DisplayMux::setBacklight(uint8_t level) {
+	DUAL_DEBUG("DisplayMux: setBacklight");
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+		sinks_[i].display->setBacklight(level);
+	}
+}
+
+uint32_t DisplayMux::pump(uint32_t budgetUs) {
+#if ENABLE_DUAL_QUEUE
+	if (!queue_enabled_) {
+		return 0;
+	}
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+		markOverdue(sinks_[i]);
+	}
+	// Round-robin: the budget is offered to pump_first_ and what it leaves
+	// carries on to the next sinks. The sink after the first one that spent
+	// anything leads next time, so one slow sink cannot take every tick.
+	uint32_t spent = 0;
+	uint8_t next_first = pump_first_;
+	bool rotated = false;
+	for (uint8_t n = 0; n < sink_count_ && spent < budgetUs; ++n) {
+		uint8_t i = static_cast<uint8_t>(pump_first_ + n);
+		if (i >= sink_count_) {
+			i = static_cast<uint8_t>(i - sink_count_);
+		}
+		const uint32_t used = pumpSink(i, budgetUs - spent);
+		spent += used;
+		if (used != 0 && !rotated) {
+			next_first = static_cast<uint8_t>(i + 1 < sink_count_ ? i + 1 : 0);
+			rotated = true;
+		}
+	}
+	pump_first_ = next_first;
+	return spent;
+#else
+	(void)budgetUs;
+	return 0;
+#endif
+}
+
+#if ENABLE_DUAL_QUEUE
+uint32_t DisplayMux::pumpSink(uint8_t index, uint32_t budgetUs) {
+	Sink &sink = sinks_[index];
+	if (sink.policy != SinkPolicy::DeferWhenQueueing || (sink.dirty_rows == 0 && sink.cgram_dirty == 0)) {
+		return 0;
+	}
+	// Nothing fits until the budget covers at least one cell.
+	if (budgetUs < sink.cell_us) {
+		return 0;
+	}
+	// The rate cap gates the start of a repaint; changes that land while it
+	// waits are coalesced into it. Once started, it continues every pump.
+	if (!sink.refreshing) {
+		const uint16_t now = RefreshTick.now();
+		if (sink.min_refresh_ticks != 0 && static_cast<uint16_t>(now - sink.last_refresh_tick) < sink.min_refresh_ticks) {
+			return 0;
+		}
+		sink.last_refresh_tick = now;
+		sink.refreshing = true;
+	}
+	uint32_t spent = 0;
+
+	// Flush any pending custom glyph slots first; rendering bytes 0..7 depends
+	// on these being in sync before we repaint rows from the shadow buffer.
+	// An upload is charged like eight cells.
+	while (sink.cgram_dirty != 0) {
+		if (budgetUs - spent < static_cast<uint32_t>(sink.cell_us) * 8) {
+			return spent;
+		}
+		uint8_t slot = 0;
+		while ((sink.cgram_dirty & (1U << slot)) == 0) {
+			++slot;
+		}
+		const uint32_t start = micros();
+		sink.display->createChar(slot, state_.glyphs[slot]);
+		sink.cgram_dirty &= static_cast<uint8_t>(~(1U << slot));
+		spent += micros() - start;
+		if (spent >= budgetUs) {
+			return spent;
+		}
+	}
+
+	while (sink.dirty_rows != 0) {
+		const uint32_t cells_left = spent < budgetUs ? (budgetUs - spent) / sink.cell_us : 0;
+		if (cells_left == 0) {
+			break;
+		}
+		const uint8_t row = nextRow(sink);
+
+		// Send the head of the dirty span that fits; the rest stays dirty.
+		const uint8_t first = sink.dirty_first[row];
+		uint8_t length = static_cast<uint8_t>(sink.dirty_last[row] - first + 1);
+		if (length > cells_left) {
+			length = static_cast<uint8_t>(cells_left);
+		}
+		const uint8_t *cells = state_.row(row) + first;
+		const uint32_t start = micros();
+		sink.display->writeSpan(first, row, cells, length);
+		const uint32_t duration = micros() - start;
+		spent += duration;
+		if (static_cast<uint8_t>(first + length) > sink.dirty_last[row]) {
+			sink.dirty_rows &= static_cast<uint8_t>(~(1U << row));
+			sink.overdue_rows &= static_cast<uint8_t>(~(1U << row));
+		} else {
+			sink.dirty_first[row] = static_cast<uint8_t>(first + length);
+		}
+
+		// Blend the measured per-cell cost into the estimate (3:1 toward the
+		// old value) so chunk sizes follow the sink's real speed.
+		const uint32_t measured = duration / length;
+		const uint32_t blended = (static_cast<uint32_t>(sink.cell_us) * 3 + measured) / 4;
+		sink.cell_us = static_cast<uint16_t>(blended == 0 ? 1 : blended > 0xFFFF ? 0xFFFF : blended);
+
+#if ENABLE_SERIAL_DEBUG
+		if (SerialDebug::isRuntimeEnabled()) {
+			SerialDebug::printPrefix();
+			HostSerial.print(F("dual.refresh.chunk_us="));
+			HostSerial.print(duration);
+			HostSerial.print(F(" sink="));
+			HostSerial.print(index);
+			HostSerial.print(F(" row="));
+			HostSerial.print(row);
+			HostSerial.print(F(" col="));
+			HostSerial.print(first);
+			HostSerial.print(F(" cols="));
+			HostSerial.println(length);
+		}
+#endif
+	}
+	if (sink.dirty_rows == 0 && sink.cgram_dirty == 0) {
+		sink.refreshing = false;
+	}
+	return spent;
+}
+
+void DisplayMux::markOverdue(Sink &sink) const {
+	const uint8_t now = static_cast<uint8_t>(RefreshTick.now());
+	const uint8_t young = static_cast<uint8_t>(sink.dirty_rows & ~sink.overdue_rows);
+	for (uint8_t row = 0; row < PanelGeometry::kHeight; ++row) {
+		if ((young & (1U << row)) != 0 &&
+		    static_cast<uint8_t>(now - sink.dirty_since[row]) >= kMaxRowAgeTicks) {
+			sink.overdue_rows |= static_cast<uint8_t>(1U << row);
+		}
+	}
+}
+
+uint8_t DisplayMux::nextRow(const Sink &sink) const {
+	// Overdue rows first, so a row changing every tick cannot lock out the
+	// others. They have all waited past the bound; take them in row order.
+	if (sink.overdue_rows != 0) {
+		uint8_t row = 0;
+		while ((sink.overdue_rows & (1U << row)) == 0) {
+			++row;
+		}
+		return row;
+	}
+	const uint8_t now = static_cast<uint8_t>(RefreshTick.now());
+	uint8_t best = 0xFF;
+	// Otherwise the most recently changed row (what the user is watching,
+	// e.g. clock seconds), the smaller pending span on ties.
+	uint8_t best_recency = 0xFF;
+	uint8_t best_span = 0xFF;
+	for (uint8_t row = 0; row < PanelGeometry::kHeight; ++row) {
+		if ((sink.dirty_rows & (1U << row)) == 0) {
+			continue;
+		}
+		const uint8_t recency = static_cast<uint8_t>(now - sink.changed_at[row]);
+		const uint8_t span = static_cast<uint8_t>(sink.dirty_last[row] - sink.dirty_first[row]);
+		if (best == 0xFF || recency < best_recency || (recency == best_recency && span < best_span)) {
+			best = row;
+			best_recency = recency;
+			best_span = span;
+		}
+	}
+	return best;
+}
+
+bool DisplayMux::deferred(const Sink &sink) const {
+	return queue_enabled_ && sink.policy == SinkPolicy::DeferWhenQueueing;
+}
+
+void DisplayMux::markDirty(Sink &sink, uint8_t row, uint8_t first, uint8_t last) {
+	const uint8_t bit = static_cast<uint8_t>(1U << row);
+	const uint8_t now = static_cast<uint8_t>(RefreshTick.now());
+	sink.changed_at[row] = now;
+	if (sink.dirty_rows & bit) {
+		if (first < sink.dirty_first[row]) {
+			sink.dirty_first[row] = first;
+		}
+		if (last > sink.dirty_last[row]) {
+			sink.dirty_last[row] = last;
+		}
+		return;
+	}
+	sink.dirty_rows |= bit;
+	sink.dirty_since[row] = now;
+	sink.dirty_first[row] = first;
+	sink.dirty_last[row] = last;
+}
+#endif
+
+size_t DisplayMux::pendingWrites(uint8_t index) const {
+#if ENABLE_DUAL_QUEUE
+	if (index >= sink_count_) {
+		return 0;
+	}
+	uint8_t count = 0;
+	uint8_t mask = sinks_[index].dirty_rows;
+	while (mask) {
+		count += static_cast<uint8_t>(mask & 1U);
+		mask >>= 1U;
+	}
+	mask = sinks_[index].cgram_dirty;
+	while (mask) {
+		count += static_cast<uint8_t>(mask & 1U);
+		mask >>= 1U;
+	}
+	return count;
+#else
+	(void)index;
+	return 0;
+#endif
+}
+
+size_t DisplayMux::pendingWrites() const {
+	size_t total = 0;
+	for (uint8_t i = 0; i < sink_count_; ++i) {
+		total += pendingWrites(i);
+	}
+	return total;
+}
+
+void DisplayMux::setQueueingEnabled(bool enabled) {
+#if ENABLE_DUAL_QUEUE
+#if ENABLE_SERIAL_DEBUG
+	if (SerialDebug::isRuntimeEnabled()) {
+		SerialDebug::printPrefix();
+		HostSerial.print(F("dual.queue.enabled="));
+		HostSerial.println(enabled ? 1 : 0);
+	}
+#endif
+	queue_enabled_ = enabled;
+#else
+	(void)enabled;
+#endif
+}
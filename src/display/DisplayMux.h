@@ -0,0 +1,102 @@
+#pragma once
+
+#include <DisplayConfig.h>
+
+#include "display/DdramGeometry.h"
+#include "display/DisplayState.h"
+#include "display/IDisplay.h"
+
+// Fans one host stream out to up to DISPLAY_MUX_MAX_SINKS panels (LCD, OLED,
+// a second OLED on another I2C address, ...). With ENABLE_DUAL_QUEUE the mux
+// keeps one shared logical frame; each deferred sink tracks how its flushed
+// view differs from it (dirty row spans + glyph slots) and catches up from
+// pump() in sub-row chunks sized to the caller's time budget, so a slow sink
+// never holds back a fast one. Pending rows go most recently changed first
+// (smallest span on ties), with an age bound so no row starves, and each sink
+// starts at most one repaint per min refresh interval. Each pump() offers its
+// budget to the sinks round-robin. Without the queue
+// every call is simply mirrored.
+class DisplayMux final : public IDisplay {
+public:
+	// How a sink is fed while queueing (StreamingSafe) is enabled. Immediate
+	// sinks are written through as bytes arrive; deferred ones are refreshed
+	// from the shared frame once the host goes idle.
+	enum class SinkPolicy : uint8_t {
+		Immediate,
+		DeferWhenQueueing,
+	};
+
+	// With ENABLE_DUAL_QUEUE, `state` is the shared logical frame and glyph bank.
+	explicit DisplayMux(DisplayState &state);
+
+	// `minRefreshTicks` is the shortest gap, in RefreshTick ticks, between the
+	// starts of two repaints of the sink; a repaint in progress always runs to
+	// completion. Returns false once DISPLAY_MUX_MAX_SINKS sinks are attached.
+	bool addSink(IDisplay &display, SinkPolicy policy, uint16_t minRefreshTicks = 0);
+	// Seed a sink's refresh cost with a measured full-row write; pump() sizes
+	// its chunks from it and keeps refining it from the chunks it times.
+	void setRowCostUs(uint8_t index, uint32_t rowUs);
+	uint8_t sinkCount() const;
+	IDisplay &sink(uint8_t index);
+
+	void begin(uint8_t width, uint8_t height) override;
+	void clear() override;
+	void home() override;
+	void display() override;
+	void setCursor(uint8_t column, uint8_t row) override;
+	size_t write(uint8_t value) override;
+	using IDisplay::write;
+	size_t writeSpan(uint8_t column, uint8_t row, const uint8_t *data, uint8_t length) override;
+	void createChar(uint8_t slot, const uint8_t bitmap[8]) override;
+	void command(uint8_t value) override;
+	void setBacklight(uint8_t level) override;
+
+	// Catch deferred sinks up for at most `budgetUs` (plus one cell's worth of
+	// estimation error). Returns the microseconds actually spent.
+	uint32_t pump(uint32_t budgetUs);
+	size_t pendingWrites() const;
+	size_t pendingWrites(uint8_t index) const;
+	void setQueueingEnabled(bool enabled);
+
+private:
+	struct Sink {
+		IDisplay *display;
+#if ENABLE_DUAL_QUEUE
+		SinkPolicy policy;
+		uint16_t cell_us; // running estimate of one cell's refresh cost
+		uint16_t min_refresh_ticks;
+		uint16_t last_refresh_tick;
+		// Rows (and the [first, last] columns within them) where this sink's
+		// flushed view is behind the shared frame, plus glyph slots it lacks.
+		uint8_t dirty_rows;
+		uint8_t dirty_first[PanelGeometry::kHeight];
+		uint8_t dirty_last[PanelGeometry::kHeight];
+		// Low byte of RefreshTick::now() when each row last changed and when
+		// it first became dirty; drive the refresh order.
+		uint8_t changed_at[PanelGeometry::kHeight];
+		uint8_t dirty_since[PanelGeometry::kHeight];
+		// Rows that reached the age bound. Latched by every pump() so the
+		// 8-bit age wrapping after 256 ticks cannot make them look young.
+		uint8_t overdue_rows;
+		uint8_t cgram_dirty;
+		bool refreshing; // a repaint has started and not yet caught up
+#endif
+	};
+
+	Sink sinks_[DISPLAY_MUX_MAX_SINKS];
+	uint8_t sink_count_ = 0;
+
+#if ENABLE_DUAL_QUEUE
+	bool deferred(const Sink &sink) const;
+	void markDirty(Sink &sink, uint8_t row, uint8_t first, uint8_t last);
+	uint32_t pumpSink(uint8_t index, uint32_t budgetUs);
+	uint8_t nextRow(const Sink &sink) const;
+	void markOverdue(Sink &sink) const;
+
+	uint8_t cursor_column_ = 0;
+	uint8_t cursor_row_ = 0;
+	bool queue_enabled_ = false;
+	uint8_t pump_first_ = 0; // sink offered the budget first by the next pump()
+#endif
+	DisplayState &state_;
+};
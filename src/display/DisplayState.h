@@ -0,0 +1,32 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <DisplayConfig.h>
+
+#include "display/DdramGeometry.h"
+
+// The logical screen the host has asked for: the visible text grid (row-major,
+// PanelGeometry-sized) and the eight custom glyph bitmaps. One instance is
+// owned by display_factory.cpp (see displayState()) and shared by the command
+// translator, the display mux and the frame buffer, so no layer keeps its own
+// copy of the same bytes. Only the frame buffer and the dual queue read the
+// text grid, so other builds leave it out and keep just the glyphs.
+#if ENABLE_FRAME_BUFFER || ENABLE_DUAL_QUEUE
+#define DISPLAY_STATE_HAS_TEXT 1
+#else
+#define DISPLAY_STATE_HAS_TEXT 0
+#endif
+
+struct DisplayState {
+#if DISPLAY_STATE_HAS_TEXT
+	uint8_t text[PanelGeometry::kCells];
+#endif
+	uint8_t glyphs[8][8];
+
+#if DISPLAY_STATE_HAS_TEXT
+	uint8_t *row(uint8_t index) {
+		return &text[static_cast<uint16_t>(index) * PanelGeometry::kWidth];
+	}
+#endif
+};
@@ -0,0 +1,160 @@
+#include "display/FrameBufferDisplay.h"
+
+#include <Arduino.h>
+#include <DisplayConfig.h>
+#include <string.h>
+
+#include "display/ActiveDisplay.h"
+
+#if ENABLE_FRAME_BUFFER
+
+template <typename Inner>
+BasicFrameBufferDisplay<Inner>::BasicFrameBufferDisplay(Inner &inner, DisplayState &state)
+    : inner_(inner), back_(state.text) {
+	memset(front_, ' ', sizeof(front_));
+	memset(back_, ' ', PanelGeometry::kCells);
+}
+
+template <typename Inner>
+void BasicFrameBufferDisplay<Inner>::begin(uint8_t width, uint8_t height) {
+	inner_.begin(width, height);
+	inner_.clear();
+	memset(front_, ' ', sizeof(front_));
+	memset(back_, ' ', PanelGeometry::kCells);
+	cursor_column_ = 0;
+	cursor_row_ = 0;
+	dirty_ = false;
+}
+
+template <typename Inner>
+void BasicFrameBufferDisplay<Inner>::clear() {
+	memset(back_, ' ', PanelGeometry::kCells);
+	cursor_column_ = 0;
+	cursor_row_ = 0;
+	dirty_ = true;
+}
+
+template <typename Inner>
+void BasicFrameBufferDisplay<Inner>::home() {
+	cursor_column_ = 0;
+	cursor_row_ = 0;
+}
+
+template <typename Inner>
+void BasicFrameBufferDisplay<Inner>::display() {
+	inner_.display();
+}
+
+template <typename Inner>
+void BasicFrameBufferDisplay<Inner>::setCursor(uint8_t column, uint8_t row) {
+	cursor_column_ = column;
+	cursor_row_ = row;
+}
+
+template <typename Inner>
+size_t BasicFrameBufferDisplay<Inner>::write(uint8_t value) {
+	if (cursor_row_ < PanelGeometry::kHeight && cursor_column_ < PanelGeometry::kWidth) {
+		back_[static_cast<uint16_t>(cursor_row_) * PanelGeometry::kWidth + cursor_column_] = value;
+		dirty_ = true;
+	}
+	if (++cursor_column_ >= PanelGeometry::kWidth) {
+		cursor_column_ = 0;
+		cursor_row_ = static_cast<uint8_t>((cursor_row_ + 1) % PanelGeometry::kHeight);
+	}
+	return 1;
+}
+
+template <typename Inner>
+size_t BasicFrameBufferDisplay<Inner>::writeSpan(uint8_t column, uint8_t row, const uint8_t *data, uint8_t length) {
+	if (row < PanelGeometry::kHeight && column < PanelGeometry::kWidth) {
+		const uint8_t room = static_cast<uint8_t>(PanelGeometry::kWidth - column);
+		memcpy(&back_[static_cast<uint16_t>(row) * PanelGeometry::kWidth + column], data,
+		       length < room ? length : room);
+		dirty_ = true;
+	}
+	const uint16_t end = static_cast<uint16_t>(column) + length;
+	if (end >= PanelGeometry::kWidth) {
+		cursor_column_ = 0;
+		cursor_row_ = static_cast<uint8_t>((row + 1) % PanelGeometry::kHeight);
+	} else {
+		cursor_column_ = static_cast<uint8_t>(end);
+		cursor_row_ = row;
+	}
+	return length;
+}
+
+template <typename Inner>
+void BasicFrameBufferDisplay<Inner>::createChar(uint8_t slot, const uint8_t bitmap[8]) {
+	inner_.createChar(slot, bitmap);
+	// Cells already showing this glyph must be redrawn on backends that render
+	// glyphs at write time, so invalidate their front copies.
+	for (uint16_t i = 0; i < PanelGeometry::kCells; ++i) {
+		if (front_[i] < 0x10 && (front_[i] & 0x07) == (slot & 0x07)) {
+			front_[i] = static_cast<uint8_t>(~back_[i]);
+			dirty_ = true;
+		}
+	}
+}
+
+template <typename Inner>
+void BasicFrameBufferDisplay<Inner>::command(uint8_t value) {
+	inner_.command(value);
+}
+
+template <typename Inner>
+void BasicFrameBufferDisplay<Inner>::setBacklight(uint8_t level) {
+	inner_.setBacklight(level);
+}
+
+template <typename Inner>
+uint32_t BasicFrameBufferDisplay<Inner>::flush(uint32_t budgetUs) {
+	if (!dirty_) {
+		return 0;
+	}
+	uint32_t spent = 0;
+	for (uint8_t row = 0; row < PanelGeometry::kHeight; ++row) {
+		const uint16_t base = static_cast<uint16_t>(row) * PanelGeometry::kWidth;
+		uint8_t column = 0;
+		while (column < PanelGeometry::kWidth) {
+			if (front_[base + column] == back_[base + column]) {
+				++column;
+				continue;
+			}
+			const uint32_t cells_left = spent < budgetUs ? (budgetUs - spent) / cell_us_ : 0;
+			if (cells_left == 0) {
+				return spent; // still dirty; resume from here next time
+			}
+			const uint8_t start = column;
+			while (column < PanelGeometry::kWidth && front_[base + column] != back_[base + column] &&
+			       static_cast<uint8_t>(column - start) < cells_left) {
+				front_[base + column] = back_[base + column];
+				++column;
+			}
+			const uint8_t length = static_cast<uint8_t>(column - start);
+			const uint32_t begin = micros();
+			inner_.writeSpan(start, row, &back_[base + start], length);
+			const uint32_t duration = micros() - begin;
+			spent += duration;
+			// Follow the panel's real speed, weighted 3:1 toward the old estimate.
+			const uint32_t blended = (static_cast<uint32_t>(cell_us_) * 3 + duration / length) / 4;
+			cell_us_ = static_cast<uint16_t>(blended == 0 ? 1 : blended > 0xFFFF ? 0xFFFF : blended);
+		}
+	}
+	dirty_ = false;
+	return spent;
+}
+
+template <typename Inner>
+void BasicFrameBufferDisplay<Inner>::setRowCostUs(uint32_t rowUs) {
+	const uint32_t cell = rowUs / PanelGeometry::kWidth;
+	cell_us_ = static_cast<uint16_t>(cell == 0 ? 1 : cell > 0xFFFF ? 0xFFFF : cell);
+}
+
+template <typename Inner>
+bool BasicFrameBufferDisplay<Inner>::pending() const {
+	return dirty_;
+}
+
+template class BasicFrameBufferDisplay<PanelDisplay>;
+
+#endif
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <DisplayConfig.h>
+
+#include "display/DdramGeometry.h"
+#include "display/DisplayState.h"
+#include "display/IDisplay.h"
+
+// Decorator for single-backend builds: writes land in a back buffer (what the
+// host wants) and flush() sends only the cells that differ from the front
+// buffer (what is on glass), so lcdproc repainting identical text every
+// refresh costs no display I/O. Clear/home/setCursor are pure bookkeeping.
+// Templated on the inner display type so flush() calls the backend directly;
+// members live in the .cpp and are instantiated for the build's panel type
+// (see ActiveDisplay.h).
+template <typename Inner>
+class BasicFrameBufferDisplay final : public IDisplay {
+public:
+	// The back buffer is the shared `state.text`; only the front copy is ours.
+	BasicFrameBufferDisplay(Inner &inner, DisplayState &state);
+
+	void begin(uint8_t width, uint8_t height) override;
+	void clear() override;
+	void home() override;
+	void display() override;
+	void setCursor(uint8_t column, uint8_t row) override;
+	size_t write(uint8_t value) override;
+	using IDisplay::write;
+	size_t writeSpan(uint8_t column, uint8_t row, const uint8_t *data, uint8_t length) override;
+	void createChar(uint8_t slot, const uint8_t bitmap[8]) override;
+	void command(uint8_t value) override;
+	void setBacklight(uint8_t level) override;
+
+	// Push differing cells to the inner display, one writeSpan() per run, for
+	// at most `budgetUs`; runs that do not fit are cut and finished next call.
+	// Returns the microseconds spent.
+	uint32_t flush(uint32_t budgetUs);
+	// Seed the per-cell cost estimate from a measured full-row write.
+	void setRowCostUs(uint32_t rowUs);
+	bool pending() const;
+
+private:
+	Inner &inner_;
+	uint8_t *const back_;
+	uint8_t cursor_column_ = 0;
+	uint8_t cursor_row_ = 0;
+	bool dirty_ = false;
+	uint16_t cell_us_ = 1;
+	uint8_t front_[PanelGeometry::kCells];
+};
@@ -23,14 +23,6 @@ void HD44780Display::display() {
 	lcd_.display();
 }
 
-void HD44780Display::setCursor(uint8_t column, uint8_t row) {
-	lcd_.setCursor(column, row);
-}
-
-size_t HD44780Display::write(uint8_t value) {
-	return lcd_.write(value);
-}
-
 size_t HD44780Display::write(const char *str) {
 	if (!str) {
 		return 0;
@@ -5,7 +5,7 @@
 
 #include "display/IDisplay.h"
 
-class HD44780Display : public IDisplay {
+class HD44780Display final : public IDisplay {
 public:
 	HD44780Display(uint8_t rs, uint8_t enable,
 	               uint8_t d0, uint8_t d1, uint8_t d2, uint8_t d3,
@@ -16,14 +16,30 @@ public:
 	void clear() override;
 	void home() override;
 	void display() override;
+	// The per-byte calls are defined inline below so statically dispatched
+	// callers compile straight down to LiquidCrystal.
 	void setCursor(uint8_t column, uint8_t row) override;
 	size_t write(uint8_t value) override;
 	size_t write(const char *str) override;
 	void createChar(uint8_t slot, const uint8_t bitmap[8]) override;
 	void command(uint8_t value) override;
 	void setBacklight(uint8_t level) override;
+	size_t writeSpan(uint8_t column, uint8_t row, const uint8_t *data, uint8_t length) override;
 
 private:
 	LiquidCrystal lcd_;
 	uint8_t backlightPin_;
 };
+
+inline void HD44780Display::setCursor(uint8_t column, uint8_t row) {
+	lcd_.setCursor(column, row);
+}
+
+inline size_t HD44780Display::write(uint8_t value) {
+	return lcd_.write(value);
+}
+
+inline size_t HD44780Display::writeSpan(uint8_t column, uint8_t row, const uint8_t *data, uint8_t length) {
+	lcd_.setCursor(column, row);
+	return lcd_.write(data, length);
+}
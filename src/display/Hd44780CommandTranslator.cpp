@@ -5,12 +5,18 @@
 
 #include "SerialDebug.h"
 
-Hd44780CommandTranslator::Hd44780CommandTranslator(IDisplay &display)
-    : display_(display) {
+namespace {
+constexpr uint8_t kNoSlot = 0xFF;
+}
+
+template <typename Geometry, typename Display>
+BasicHd44780CommandTranslator<Geometry, Display>::BasicHd44780CommandTranslator(Display &display, DisplayState &state)
+    : display_(display), state_(state) {
 	reset();
 }
 
-void Hd44780CommandTranslator::reset() {
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::reset() {
 	display_cursor_row_ = 0;
 	display_cursor_column_ = 0;
 	force_set_cursor_ = false;
@@ -22,12 +28,25 @@ void Hd44780CommandTranslator::reset() {
 	ddram_address_ = 0;
 	cgram_active_ = false;
 	cgram_address_ = 0;
-	memset(cgram_cache_, 0, sizeof(cgram_cache_));
+	memset(state_.glyphs, 0, sizeof(state_.glyphs));
+	cgram_dirty_slot_ = kNoSlot;
+#if ENABLE_SPAN_BATCHING
+	span_row_ = 0;
+	span_column_ = 0;
+	span_length_ = 0;
+#endif
 	logical_row_ = 0;
 	logical_column_ = 0;
+#if ENABLE_DISPLAY_SHIFT
+	memset(ddram_shadow_, ' ', sizeof(ddram_shadow_));
+	shift_offset_ = 0;
+	repaint_pending_ = false;
+#endif
 }
 
-void Hd44780CommandTranslator::handleCommand(uint8_t value) {
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::handleCommand(uint8_t value) {
+	flushSpan();
 	if (value == 0x01) {
 		handleClear();
 		return;
@@ -63,10 +82,15 @@ void Hd44780CommandTranslator::handleCommand(uint8_t value) {
 	// Unsupported commands are ignored; LCDproc rarely emits the remaining opcodes.
 }
 
-bool Hd44780CommandTranslator::handleData(uint8_t value) {
+template <typename Geometry, typename Display>
+bool BasicHd44780CommandTranslator<Geometry, Display>::handleData(uint8_t value) {
 	if (cgram_active_) {
 		updateCgram(static_cast<uint8_t>(value & 0x1F));
 		advanceCgramAddress();
+		// A glyph is complete once the address counter leaves its slot.
+		if (cgramSlot() != cgram_dirty_slot_) {
+			flushPendingGlyph();
+		}
 		return true;
 	}
 
@@ -75,46 +99,202 @@ bool Hd44780CommandTranslator::handleData(uint8_t value) {
 	const uint8_t current_column = logical_column_;
 	const uint8_t current_ddram = ddram_address_;
 #endif
-	// Avoid calling setCursor() for every byte: it's expensive on HD44780 and
-	// quickly overruns the UART during fast bursts. Only reposition when the
-	// display cursor is no longer at the logical cursor.
-	if (display_cursor_row_ != logical_row_ || display_cursor_column_ != logical_column_) {
-		display_.setCursor(logical_column_, logical_row_);
-		display_cursor_row_ = logical_row_;
-		display_cursor_column_ = logical_column_;
-	}
-	display_.write(value);
-	advanceDdramAddress();
-	if (force_set_cursor_) {
+	uint8_t visible_row = 0;
+	uint8_t visible_column = 0;
+	const bool visible = Geometry::decode(ddram_address_, visible_row, visible_column);
+#if ENABLE_DISPLAY_SHIFT
+	storeShadow(ddram_address_, value);
+	if (shift_offset_ != 0 || shift_on_write_ || !visible) {
+		// While shifted, the visible column for this address moves around, so
+		// only the shadow is updated and the panel is repainted at idle. An
+		// unshifted write outside the window only lands in the shadow.
+		flushSpan();
+		advanceDdramAddress();
+		force_set_cursor_ = false;
 		display_cursor_row_ = 0xFF;
 		display_cursor_column_ = 0xFF;
+		if (shift_on_write_) {
+			shiftDisplay(increment_);
+		}
+		if (shift_offset_ != 0) {
+			repaint_pending_ = true;
+		}
+	} else
+#else
+	if (!visible) {
+		// Outside the panel window the controller keeps the byte unseen in
+		// DDRAM; without a shadow there is nothing to store.
+		flushSpan();
+		advanceDdramAddress();
 		force_set_cursor_ = false;
-	} else {
-		display_cursor_row_ = logical_row_;
-		display_cursor_column_ = logical_column_;
+		display_cursor_row_ = 0xFF;
+		display_cursor_column_ = 0xFF;
+	} else
+#endif
+#if ENABLE_SPAN_BATCHING
+	if (increment_) {
+		// Consecutive bytes on one row are batched and sent as a single
+		// writeSpan() once the row wraps, a command arrives, or the caller
+		// flushes at the end of the RX batch.
+		if (span_length_ == 0) {
+			span_row_ = logical_row_;
+			span_column_ = logical_column_;
+		}
+		span_[span_length_++] = value;
+		advanceDdramAddress();
+		if (force_set_cursor_) {
+			flushSpan();
+		}
+	} else
+#endif
+	{
+		// Decrementing entry mode walks backwards (and builds without span
+		// batching write every byte); keep the per-byte path.
+		flushSpan();
+		// Avoid calling setCursor() for every byte: it's expensive on HD44780 and
+		// quickly overruns the UART during fast bursts. Only reposition when the
+		// display cursor is no longer at the logical cursor.
+		if (display_cursor_row_ != logical_row_ || display_cursor_column_ != logical_column_) {
+			display_.setCursor(logical_column_, logical_row_);
+			display_cursor_row_ = logical_row_;
+			display_cursor_column_ = logical_column_;
+		}
+		display_.write(value);
+		advanceDdramAddress();
+		if (force_set_cursor_) {
+			display_cursor_row_ = 0xFF;
+			display_cursor_column_ = 0xFF;
+			force_set_cursor_ = false;
+		} else {
+			display_cursor_row_ = logical_row_;
+			display_cursor_column_ = logical_column_;
+		}
 	}
 #if ENABLE_SERIAL_DEBUG
 	if (SerialDebug::isRuntimeEnabled()) {
 		const int16_t delta = static_cast<int16_t>(static_cast<int8_t>(ddram_address_) -
 		                                           static_cast<int8_t>(current_ddram));
 		SerialDebug::printPrefix();
-		Serial.print(F("translator.ddram addr=0x"));
-		Serial.print(current_ddram, HEX);
-		Serial.print(F(" row="));
-		Serial.print(current_row);
-		Serial.print(F(" col="));
-		Serial.print(current_column);
-		Serial.print(F(" delta="));
-		Serial.println(delta);
+		HostSerial.print(F("translator.ddram addr=0x"));
+		HostSerial.print(current_ddram, HEX);
+		HostSerial.print(F(" row="));
+		HostSerial.print(current_row);
+		HostSerial.print(F(" col="));
+		HostSerial.print(current_column);
+		HostSerial.print(F(" delta="));
+		HostSerial.println(delta);
 	}
 #endif
 	return true;
 }
 
-void Hd44780CommandTranslator::handleClear() {
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::writeRegion(uint8_t row, uint8_t column, const uint8_t *data, uint8_t length) {
+	exitCgramMode();
+	if (!data || row >= Geometry::kHeight || column >= Geometry::kWidth) {
+		return;
+	}
+	if (length > Geometry::kWidth - column) {
+		length = static_cast<uint8_t>(Geometry::kWidth - column);
+	}
+	flushSpan();
+#if ENABLE_DISPLAY_SHIFT
+	for (uint8_t i = 0; i < length; ++i) {
+		storeShadow(Geometry::encode(row, static_cast<uint8_t>(column + i)), data[i]);
+	}
+	if (shift_offset_ != 0) {
+		repaint_pending_ = true;
+	} else
+#endif
+	display_.writeSpan(column, row, data, length);
+
+	// Leave the address counter just past the span, as if the host had sent
+	// `FE 80|addr` followed by the same bytes: a full row continues along the
+	// 40-byte DDRAM line (0x14 after row 0 on 20x4), or on the other line.
+	const uint8_t end = static_cast<uint8_t>(column + length);
+	uint8_t address = static_cast<uint8_t>(Geometry::rowBase(row) + end);
+	if ((address & 0x3F) >= kDdramLineLength) {
+		address = static_cast<uint8_t>((address & 0x40) ^ 0x40);
+	}
+	ddram_address_ = address;
+	syncLogicalCursor();
+	if (end >= Geometry::kWidth) {
+		display_cursor_row_ = 0xFF;
+		display_cursor_column_ = 0xFF;
+	} else {
+		display_cursor_row_ = row;
+		display_cursor_column_ = end;
+	}
+}
+
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::flushSpan() {
+#if ENABLE_SPAN_BATCHING
+	if (span_length_ == 0) {
+		return;
+	}
+	const uint8_t length = span_length_;
+	span_length_ = 0;
+	display_.writeSpan(span_column_, span_row_, span_, length);
+	const uint8_t end = static_cast<uint8_t>(span_column_ + length);
+	if (end >= Geometry::kWidth) {
+		display_cursor_row_ = 0xFF;
+		display_cursor_column_ = 0xFF;
+	} else {
+		display_cursor_row_ = span_row_;
+		display_cursor_column_ = end;
+	}
+	force_set_cursor_ = false;
+#endif
+}
+
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::flushViewport() {
+#if ENABLE_DISPLAY_SHIFT
+	if (!repaint_pending_) {
+		return;
+	}
+	flushSpan();
+	repaint_pending_ = false;
+	uint8_t cells[Geometry::kWidth];
+	for (uint8_t row = 0; row < Geometry::kHeight; ++row) {
+		const uint8_t base = Geometry::rowBase(row);
+		const uint8_t *line = ddram_shadow_[base >> 6];
+		uint8_t position = static_cast<uint8_t>(((base & 0x3F) + shift_offset_) % kDdramLineLength);
+		for (uint8_t column = 0; column < Geometry::kWidth; ++column) {
+			cells[column] = line[position];
+			if (++position >= kDdramLineLength) {
+				position = 0;
+			}
+		}
+		display_.writeSpan(0, row, cells, Geometry::kWidth);
+	}
+	display_cursor_row_ = 0xFF;
+	display_cursor_column_ = 0xFF;
+#endif
+}
+
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::flushPendingGlyph() {
+	if (cgram_dirty_slot_ == kNoSlot) {
+		return;
+	}
+	const uint8_t slot = cgram_dirty_slot_;
+	cgram_dirty_slot_ = kNoSlot;
+	display_.createChar(slot, state_.glyphs[slot]);
+}
+
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::handleClear() {
 	exitCgramMode();
 	display_.clear();
 	display_.home();
+#if ENABLE_DISPLAY_SHIFT
+	// Clear also resets the display shift.
+	memset(ddram_shadow_, ' ', sizeof(ddram_shadow_));
+	shift_offset_ = 0;
+	repaint_pending_ = false;
+#endif
 	ddram_address_ = 0;
 	logical_row_ = 0;
 	logical_column_ = 0;
@@ -122,9 +302,17 @@ void Hd44780CommandTranslator::handleClear() {
 	display_cursor_column_ = 0;
 }
 
-void Hd44780CommandTranslator::handleHome() {
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::handleHome() {
 	exitCgramMode();
 	display_.home();
+#if ENABLE_DISPLAY_SHIFT
+	// Return home undoes any display shift without touching DDRAM.
+	if (shift_offset_ != 0) {
+		shift_offset_ = 0;
+		repaint_pending_ = true;
+	}
+#endif
 	ddram_address_ = 0;
 	logical_row_ = 0;
 	logical_column_ = 0;
@@ -132,12 +320,14 @@ void Hd44780CommandTranslator::handleHome() {
 	display_cursor_column_ = 0;
 }
 
-void Hd44780CommandTranslator::handleEntryMode(uint8_t value) {
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::handleEntryMode(uint8_t value) {
 	increment_ = (value & 0x02) != 0;
 	shift_on_write_ = (value & 0x01) != 0;
 }
 
-void Hd44780CommandTranslator::handleDisplayControl(uint8_t value) {
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::handleDisplayControl(uint8_t value) {
 	const bool display_on = (value & 0x04) != 0;
 	const bool cursor_on = (value & 0x02) != 0;
 	const bool blink_on = (value & 0x01) != 0;
@@ -150,111 +340,112 @@ void Hd44780CommandTranslator::handleDisplayControl(uint8_t value) {
 	// Cursor/blink toggles are currently no-ops; add support once IDisplay exposes them.
 }
 
-void Hd44780CommandTranslator::handleFunctionSet(uint8_t value) {
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::handleFunctionSet(uint8_t value) {
 	(void)value;
 	// LCDproc may tweak DL/N/F bits during init; nothing for us to do with those.
 }
 
-void Hd44780CommandTranslator::handleCursorShift(uint8_t value) {
-	(void)value;
-	// Cursor/display shift instructions would require manual text reflow.
-	// For now we ignore them; LCDproc rarely issues these during normal dashboards.
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::handleCursorShift(uint8_t value) {
+	const bool right = (value & 0x04) != 0;
+	if (value & 0x08) {
+#if ENABLE_DISPLAY_SHIFT
+		// Display shift only moves the viewport; the repaint happens at idle,
+		// so a marquee step costs two host bytes and O(1) work here.
+		shiftDisplay(!right);
+#endif
+		return;
+	}
+	// Cursor move: step the address counter without writing anything.
+	exitCgramMode();
+	const bool increment = increment_;
+	increment_ = right;
+	advanceDdramAddress();
+	increment_ = increment;
+	force_set_cursor_ = false;
 }
 
-void Hd44780CommandTranslator::handleSetCgramAddress(uint8_t value) {
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::handleSetCgramAddress(uint8_t value) {
 	cgram_active_ = true;
 	cgram_address_ = static_cast<uint8_t>(value & 0x3F);
+	if (cgramSlot() != cgram_dirty_slot_) {
+		flushPendingGlyph();
+	}
 }
 
-void Hd44780CommandTranslator::handleSetDdramAddress(uint8_t value) {
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::handleSetDdramAddress(uint8_t value) {
 	exitCgramMode();
+	// Any address on a 40-byte line is valid; one outside the panel window
+	// still moves the counter (into the shadow, with ENABLE_DISPLAY_SHIFT).
+	if ((value & 0x3F) >= kDdramLineLength) {
+		return;
+	}
 	ddram_address_ = static_cast<uint8_t>(value & 0x7F);
+	if (syncLogicalCursor()) {
+		display_.setCursor(logical_column_, logical_row_);
+		display_cursor_row_ = logical_row_;
+		display_cursor_column_ = logical_column_;
+	} else {
+		display_cursor_row_ = 0xFF;
+		display_cursor_column_ = 0xFF;
+	}
+}
+
+template <typename Geometry, typename Display>
+bool BasicHd44780CommandTranslator<Geometry, Display>::syncLogicalCursor() {
 	uint8_t row = 0;
 	uint8_t column = 0;
-	if (decodeDdramAddress(ddram_address_, row, column)) {
-		logical_row_ = row;
-		logical_column_ = column;
-		display_.setCursor(column, row);
-		display_cursor_row_ = row;
-		display_cursor_column_ = column;
+	if (!Geometry::decode(ddram_address_, row, column)) {
+		return false;
 	}
+	logical_row_ = row;
+	logical_column_ = column;
+	return true;
 }
 
-void Hd44780CommandTranslator::exitCgramMode() {
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::exitCgramMode() {
+	flushPendingGlyph();
 	cgram_active_ = false;
 }
 
-bool Hd44780CommandTranslator::decodeDdramAddress(uint8_t address, uint8_t &row, uint8_t &column) const {
-	static constexpr uint8_t offsets4[] = {0x00, 0x40, 0x14, 0x54};
-	static constexpr uint8_t offsets2[] = {0x00, 0x40};
-	static constexpr uint8_t offsets1[] = {0x00};
-
-	const uint8_t *offsets = nullptr;
-	uint8_t row_count = 0;
-
-	if (LCDH >= 4) {
-		offsets = offsets4;
-		row_count = 4;
-	} else if (LCDH == 3) {
-		offsets = offsets4;
-		row_count = 3;
-	} else if (LCDH == 2) {
-		offsets = offsets2;
-		row_count = 2;
-	} else {
-		offsets = offsets1;
-		row_count = 1;
-	}
-
-	for (uint8_t r = 0; r < row_count; ++r) {
-		const uint8_t offset = offsets[r];
-		const uint8_t end = static_cast<uint8_t>(offset + LCDW);
-		if (address >= offset && address < end) {
-			row = r;
-			column = static_cast<uint8_t>(address - offset);
-			return true;
-		}
+#if ENABLE_DISPLAY_SHIFT
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::storeShadow(uint8_t address, uint8_t value) {
+	const uint8_t position = static_cast<uint8_t>(address & 0x3F);
+	if (position < kDdramLineLength) {
+		ddram_shadow_[(address >> 6) & 0x01][position] = value;
 	}
-	return false;
 }
 
-uint8_t Hd44780CommandTranslator::encodeDdramAddress(uint8_t row, uint8_t column) const {
-	static constexpr uint8_t offsets4[] = {0x00, 0x40, 0x14, 0x54};
-	static constexpr uint8_t offsets2[] = {0x00, 0x40};
-	static constexpr uint8_t offsets1[] = {0x00};
-
-	if (column >= LCDW) {
-		return 0;
-	}
-
-	if (LCDH >= 4) {
-		if (row >= 4) {
-			row = static_cast<uint8_t>(row % 4);
-		}
-		return static_cast<uint8_t>(offsets4[row] + column);
-	} else if (LCDH == 3) {
-		if (row >= 3) {
-			row = static_cast<uint8_t>(row % 3);
-		}
-		return static_cast<uint8_t>(offsets4[row] + column);
-	} else if (LCDH == 2) {
-		if (row >= 2) {
-			row = static_cast<uint8_t>(row % 2);
-		}
-		return static_cast<uint8_t>(offsets2[row] + column);
-	} else {
-		return static_cast<uint8_t>(offsets1[0] + column);
-	}
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::shiftDisplay(bool left) {
+	// Shifting left slides the text left, i.e. the window starts one cell later.
+	shift_offset_ = static_cast<uint8_t>((shift_offset_ + (left ? 1 : kDdramLineLength - 1)) % kDdramLineLength);
+	repaint_pending_ = true;
 }
+#endif
 
-void Hd44780CommandTranslator::updateCgram(uint8_t value) {
-	const uint8_t slot = static_cast<uint8_t>((cgram_address_ >> 3) & 0x07);
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::updateCgram(uint8_t value) {
+	// Only cache the row here; the glyph is sent once via flushPendingGlyph()
+	// instead of re-sending all eight rows for every byte.
+	const uint8_t slot = cgramSlot();
 	const uint8_t row = static_cast<uint8_t>(cgram_address_ & 0x07);
-	cgram_cache_[slot][row] = value;
-	display_.createChar(slot, cgram_cache_[slot]);
+	state_.glyphs[slot][row] = value;
+	cgram_dirty_slot_ = slot;
 }
 
-void Hd44780CommandTranslator::advanceCgramAddress() {
+template <typename Geometry, typename Display>
+uint8_t BasicHd44780CommandTranslator<Geometry, Display>::cgramSlot() const {
+	return static_cast<uint8_t>((cgram_address_ >> 3) & 0x07);
+}
+
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::advanceCgramAddress() {
 	uint8_t next = cgram_address_;
 	if (increment_) {
 		next = static_cast<uint8_t>((next + 1) & 0x3F);
@@ -264,28 +455,30 @@ void Hd44780CommandTranslator::advanceCgramAddress() {
 	cgram_address_ = next;
 }
 
-void Hd44780CommandTranslator::advanceDdramAddress() {
-	if (!increment_) {
-		if (logical_column_ == 0) {
-			logical_column_ = static_cast<uint8_t>(LCDW - 1);
-			if (logical_row_ == 0) {
-				logical_row_ = static_cast<uint8_t>(LCDH - 1);
-			} else {
-				--logical_row_;
-			}
-			force_set_cursor_ = true;
-		} else {
-			--logical_column_;
+template <typename Geometry, typename Display>
+void BasicHd44780CommandTranslator<Geometry, Display>::advanceDdramAddress() {
+	// Step the counter like the controller does: along the 40-byte line, then
+	// on to the other line (0x27 -> 0x40, 0x67 -> 0x00), so a 20x4 panel fills
+	// rows 0, 2, 1, 3. The logical cursor follows whenever the new address is
+	// inside the panel window.
+	uint8_t line = static_cast<uint8_t>(ddram_address_ & 0x40);
+	uint8_t position = static_cast<uint8_t>(ddram_address_ & 0x3F);
+	if (increment_) {
+		if (++position >= kDdramLineLength) {
+			position = 0;
+			line ^= 0x40;
 		}
-		ddram_address_ = encodeDdramAddress(logical_row_, logical_column_);
-		return;
+	} else if (position == 0) {
+		position = kDdramLineLength - 1;
+		line ^= 0x40;
+	} else {
+		--position;
 	}
-
-	++logical_column_;
-	if (logical_column_ >= LCDW) {
-		logical_column_ = 0;
-		logical_row_ = static_cast<uint8_t>((logical_row_ + 1) % LCDH);
+	ddram_address_ = static_cast<uint8_t>(line | position);
+	const uint8_t previous_row = logical_row_;
+	if (!syncLogicalCursor() || logical_row_ != previous_row) {
 		force_set_cursor_ = true;
 	}
-	ddram_address_ = encodeDdramAddress(logical_row_, logical_column_);
 }
+
+template class BasicHd44780CommandTranslator<PanelGeometry, ActiveDisplay>;
@@ -1,17 +1,39 @@
 #pragma once
 
+#include <DisplayConfig.h>
 #include <stdint.h>
 
+#include "display/ActiveDisplay.h"
+#include "display/DdramGeometry.h"
+#include "display/DisplayState.h"
 #include "display/IDisplay.h"
 
-class Hd44780CommandTranslator {
+// Templated on the panel geometry so DDRAM addressing folds to constants, and
+// on the display type so calls into a `final` backend are direct rather than
+// virtual; the members live in the .cpp and are explicitly instantiated for
+// PanelGeometry and the build's ActiveDisplay.
+template <typename Geometry, typename Display = IDisplay>
+class BasicHd44780CommandTranslator {
 public:
-	explicit Hd44780CommandTranslator(IDisplay &display);
+	// CGRAM uploads are staged in `state.glyphs`, shared with the display stack.
+	BasicHd44780CommandTranslator(Display &display, DisplayState &state);
 
 	void reset();
 	void handleCommand(uint8_t value);
 	// Returns true if the byte was consumed (e.g., CGRAM programming).
 	bool handleData(uint8_t value);
+	// Bulk write of one row segment (meta opcode `FC 40`): one cursor set, then
+	// the cells, without per-byte DDRAM bookkeeping. Clipped at the row end.
+	void writeRegion(uint8_t row, uint8_t column, const uint8_t *data, uint8_t length);
+	// Send data bytes batched by handleData() as one writeSpan(). Commands and
+	// region writes flush implicitly; callers flush at the end of an RX batch.
+	void flushSpan();
+	// Push a partially uploaded glyph to the display. Called from the idle gate
+	// so a host that stops mid-glyph still sees its rows.
+	void flushPendingGlyph();
+	// Repaint every row from the DDRAM shadow after display shifts or writes
+	// made while shifted. Idle-gated like the other deferred work.
+	void flushViewport();
 
 private:
 	void handleClear();
@@ -23,13 +45,20 @@ private:
 	void handleSetCgramAddress(uint8_t value);
 	void handleSetDdramAddress(uint8_t value);
 	void exitCgramMode();
-	bool decodeDdramAddress(uint8_t address, uint8_t &row, uint8_t &column) const;
-	uint8_t encodeDdramAddress(uint8_t row, uint8_t column) const;
 	void updateCgram(uint8_t value);
 	void advanceCgramAddress();
+	uint8_t cgramSlot() const;
 	void advanceDdramAddress();
+	// Decode ddram_address_ into the logical cursor; false (cursor untouched)
+	// when the address is outside the panel window.
+	bool syncLogicalCursor();
+#if ENABLE_DISPLAY_SHIFT
+	void storeShadow(uint8_t address, uint8_t value);
+	void shiftDisplay(bool left);
+#endif
 
-	IDisplay &display_;
+	Display &display_;
+	DisplayState &state_;
 	uint8_t display_cursor_row_;
 	uint8_t display_cursor_column_;
 	bool force_set_cursor_;
@@ -41,7 +70,24 @@ private:
 	uint8_t ddram_address_;
 	bool cgram_active_;
 	uint8_t cgram_address_;
-	uint8_t cgram_cache_[8][8];
+	uint8_t cgram_dirty_slot_; // slot with rows not yet sent via createChar, or kNoSlot
+#if ENABLE_SPAN_BATCHING
+	uint8_t span_[Geometry::kWidth];
+	uint8_t span_row_;
+	uint8_t span_column_;
+	uint8_t span_length_;
+#endif
 	uint8_t logical_row_;
 	uint8_t logical_column_;
+	// HD44780 DDRAM is two 40-byte lines regardless of panel size; the panel
+	// shows a Width-wide window of each line (starting at shift_offset_ with
+	// ENABLE_DISPLAY_SHIFT).
+	static constexpr uint8_t kDdramLineLength = 40;
+#if ENABLE_DISPLAY_SHIFT
+	uint8_t ddram_shadow_[2][kDdramLineLength];
+	uint8_t shift_offset_;
+	bool repaint_pending_;
+#endif
 };
+
+using Hd44780CommandTranslator = BasicHd44780CommandTranslator<PanelGeometry, ActiveDisplay>;
@@ -17,6 +17,17 @@ public:
 	virtual void command(uint8_t value) = 0;
 	virtual void setBacklight(uint8_t level) { (void)level; }
 
+	// Write `length` cells starting at (column, row) with one cursor set.
+	// Backends override this with a tighter loop than per-byte write().
+	virtual size_t writeSpan(uint8_t column, uint8_t row, const uint8_t *data, uint8_t length) {
+		setCursor(column, row);
+		size_t written = 0;
+		for (uint8_t i = 0; i < length; ++i) {
+			written += write(data[i]);
+		}
+		return written;
+	}
+
 	// Helper for writing null-terminated strings without duplicating code in callers.
 	virtual size_t write(const char *str) {
 		if (!str) {
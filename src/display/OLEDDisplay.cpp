@@ -1,5 +1,33 @@
 #include "display/OLEDDisplay.h"
 
+#include <Wire.h>
+#include <string.h>
+
+#include "HostSerial.h"
+
+#if OLED_TX_QUEUE_SIZE > 0 && !ENABLE_LAZY_CLEAR
+#error "OLED_TX_QUEUE_SIZE needs ENABLE_LAZY_CLEAR (it queues by cell index)."
+#endif
+#if OLED_TX_QUEUE_SIZE > 0
+static_assert(OLED_TX_QUEUE_SIZE <= 255 && PanelGeometry::kCells <= 255,
+              "OLED transmit queue indices are 8-bit");
+#endif
+
+namespace {
+uint16_t i2c_timeouts = 0;
+
+// Called after every driver call that may touch the bus, so each abandoned
+// transaction is counted once.
+void noteWireTimeout() {
+#if defined(WIRE_HAS_TIMEOUT)
+	if (Wire.getWireTimeoutFlag()) {
+		Wire.clearWireTimeoutFlag();
+		++i2c_timeouts;
+	}
+#endif
+}
+} // namespace
+
 OLEDDisplay::OLEDDisplay(uint8_t resetPin, uint8_t i2cAddress)
     : oled_(resetPin), i2cAddress_(i2cAddress) {}
 
@@ -24,39 +52,277 @@ uint8_t OLEDDisplay::clampRow(uint8_t row) const {
 }
 
 void OLEDDisplay::begin(uint8_t width, uint8_t height) {
-	Serial.println(F("oled: begin entry"));
+	HostSerial.println(F("oled: begin entry"));
 	oled_.SetAddress(i2cAddress_);
-	Serial.println(F("oled: address set"));
+	HostSerial.println(F("oled: address set"));
 	columns_ = width;
 	rows_ = height;
+#if OLED_TX_QUEUE_SIZE > 0
+	tx_head_ = 0;
+	tx_count_ = 0;
+#endif
+#if defined(WIRE_HAS_TIMEOUT)
+	// twi_init() leaves the timeout alone, so this also bounds begin() itself.
+	Wire.setWireTimeout(OLED_I2C_TIMEOUT_US, true);
+#endif
 	oled_.begin(columns_, rows_);
-	Serial.println(F("oled: driver begin done"));
+	noteWireTimeout();
+	HostSerial.println(F("oled: driver begin done"));
 	oled_.home();
-	Serial.println(F("oled: home done"));
+	noteWireTimeout();
+	HostSerial.println(F("oled: home done"));
+#if ENABLE_LAZY_CLEAR
+	memset(shown_, ' ', sizeof(shown_));
+	memset(stale_, 0, sizeof(stale_));
+	stale_count_ = 0;
+	cursor_column_ = 0;
+	cursor_row_ = 0;
+	cursor_synced_ = true;
+#endif
 }
 
 void OLEDDisplay::clear() {
+#if ENABLE_LAZY_CLEAR
+	// lcd2oled's clear() rewrites the whole 1 KB frame. lcdproc clears often
+	// and redraws mostly the same text, so only mark what is not blank yet.
+	for (uint16_t i = 0; i < PanelGeometry::kCells; ++i) {
+		if (shown_[i] != ' ' && !isStale(i)) {
+			setStale(i, true);
+		}
+	}
+	cursor_column_ = 0;
+	cursor_row_ = 0;
+	cursor_synced_ = false;
+#else
 	oled_.clear();
+	noteWireTimeout();
+#endif
 }
 
 void OLEDDisplay::home() {
 	oled_.home();
+	noteWireTimeout();
+#if ENABLE_LAZY_CLEAR
+	cursor_column_ = 0;
+	cursor_row_ = 0;
+	cursor_synced_ = true;
+#endif
 }
 
 void OLEDDisplay::display() {
 	oled_.display();
+	noteWireTimeout();
 }
 
 void OLEDDisplay::setCursor(uint8_t column, uint8_t row) {
+#if ENABLE_LAZY_CLEAR
+	cursor_column_ = clampColumn(column);
+	cursor_row_ = clampRow(row);
+	cursor_synced_ = false;
+#else
 	oled_.setCursor(clampColumn(column), clampRow(row));
+	noteWireTimeout();
+#endif
 }
 
 size_t OLEDDisplay::write(uint8_t value) {
-	return oled_.write(value);
+#if ENABLE_LAZY_CLEAR
+	if (cursor_row_ >= PanelGeometry::kHeight || cursor_column_ >= PanelGeometry::kWidth) {
+#if OLED_TX_QUEUE_SIZE > 0
+		flushTx();
+#endif
+		cursor_synced_ = false;
+		const size_t written = oled_.write(value);
+		noteWireTimeout();
+		return written;
+	}
+	const uint16_t index = static_cast<uint16_t>(cursor_row_) * PanelGeometry::kWidth + cursor_column_;
+	if (isStale(index)) {
+		setStale(index, false);
+		// Redrawn with what is already on the glass: nothing to send. Glyph
+		// slots are always rewritten since createChar() may have changed them.
+		if (static_cast<uint8_t>(shown_[index]) == value && value >= 0x10) {
+			advanceCursor();
+			cursor_synced_ = false;
+			return 1;
+		}
+	}
+	sendCell(index, value);
+	shown_[index] = static_cast<char>(value);
+	advanceCursor();
+	return 1;
+#else
+	const size_t written = oled_.write(value);
+	noteWireTimeout();
+	return written;
+#endif
+}
+
+size_t OLEDDisplay::writeSpan(uint8_t column, uint8_t row, const uint8_t *data, uint8_t length) {
+#if ENABLE_LAZY_CLEAR
+	setCursor(column, row);
+	size_t written = 0;
+	for (uint8_t i = 0; i < length; ++i) {
+		written += write(data[i]);
+	}
+	return written;
+#else
+	oled_.setCursor(clampColumn(column), clampRow(row));
+	const size_t written = oled_.write(data, length);
+	noteWireTimeout();
+	return written;
+#endif
+}
+
+void OLEDDisplay::flushClear() {
+#if ENABLE_LAZY_CLEAR
+	if (stale_count_ == 0) {
+		return;
+	}
+#if OLED_TX_QUEUE_SIZE > 0
+	flushTx();
+#endif
+	for (uint8_t row = 0; row < PanelGeometry::kHeight; ++row) {
+		const uint16_t base = static_cast<uint16_t>(row) * PanelGeometry::kWidth;
+		bool positioned = false;
+		for (uint8_t column = 0; column < PanelGeometry::kWidth; ++column) {
+			const uint16_t index = base + column;
+			if (!isStale(index)) {
+				positioned = false;
+				continue;
+			}
+			if (!positioned) {
+				oled_.setCursor(column, row);
+				positioned = true;
+			}
+			oled_.write(static_cast<uint8_t>(' '));
+			shown_[index] = ' ';
+			setStale(index, false);
+		}
+	}
+	cursor_synced_ = false;
+	noteWireTimeout();
+#endif
+}
+
+void OLEDDisplay::setTxQueueEnabled(bool enabled) {
+#if OLED_TX_QUEUE_SIZE > 0
+	tx_enabled_ = enabled;
+#else
+	(void)enabled;
+#endif
+}
+
+bool OLEDDisplay::txQueueEnabled() const {
+#if OLED_TX_QUEUE_SIZE > 0
+	return tx_enabled_;
+#else
+	return false;
+#endif
+}
+
+uint32_t OLEDDisplay::pumpTx(uint32_t budgetUs) {
+#if OLED_TX_QUEUE_SIZE > 0
+	if (tx_count_ == 0) {
+		return 0;
+	}
+	const uint32_t start = micros();
+	// Where lcd2oled's cursor sits; unknown until the first write here.
+	uint8_t next_index = 0xFF;
+	do {
+		const TxCell cell = tx_[tx_head_];
+		tx_head_ = static_cast<uint8_t>(tx_head_ + 1 == OLED_TX_QUEUE_SIZE ? 0 : tx_head_ + 1);
+		--tx_count_;
+		const uint8_t row = static_cast<uint8_t>(cell.index / PanelGeometry::kWidth);
+		const uint8_t column = static_cast<uint8_t>(cell.index % PanelGeometry::kWidth);
+		if (cell.index != next_index) {
+			oled_.setCursor(column, row);
+		}
+		oled_.write(cell.value);
+		next_index = column + 1 < PanelGeometry::kWidth ? static_cast<uint8_t>(cell.index + 1) : 0xFF;
+	} while (tx_count_ != 0 && (micros() - start) < budgetUs);
+	cursor_synced_ = false;
+	noteWireTimeout();
+	return micros() - start;
+#else
+	(void)budgetUs;
+	return 0;
+#endif
+}
+
+uint16_t OLEDDisplay::i2cTimeouts() {
+	return i2c_timeouts;
 }
 
+#if ENABLE_LAZY_CLEAR
+bool OLEDDisplay::isStale(uint16_t index) const {
+	return (stale_[index >> 3] & (1U << (index & 0x07))) != 0;
+}
+
+void OLEDDisplay::setStale(uint16_t index, bool stale) {
+	const uint8_t mask = static_cast<uint8_t>(1U << (index & 0x07));
+	if (stale) {
+		stale_[index >> 3] |= mask;
+		++stale_count_;
+	} else {
+		stale_[index >> 3] &= static_cast<uint8_t>(~mask);
+		--stale_count_;
+	}
+}
+
+// Hand one cell to the driver, or to the transmit queue while it is enabled
+// or still holds cells (so order survives turning it off mid-stream). When
+// full, the oldest queued cell is sent now.
+void OLEDDisplay::sendCell(uint16_t index, uint8_t value) {
+#if OLED_TX_QUEUE_SIZE > 0
+	if (tx_enabled_ || tx_count_ != 0) {
+		if (tx_count_ == OLED_TX_QUEUE_SIZE) {
+			pumpTx(0);
+		}
+		uint16_t slot = static_cast<uint16_t>(tx_head_) + tx_count_;
+		if (slot >= OLED_TX_QUEUE_SIZE) {
+			slot -= OLED_TX_QUEUE_SIZE;
+		}
+		tx_[slot].index = static_cast<uint8_t>(index);
+		tx_[slot].value = value;
+		++tx_count_;
+		return;
+	}
+#else
+	(void)index;
+#endif
+	if (!cursor_synced_) {
+		oled_.setCursor(cursor_column_, cursor_row_);
+		cursor_synced_ = true;
+	}
+	oled_.write(value);
+	noteWireTimeout();
+}
+
+#if OLED_TX_QUEUE_SIZE > 0
+void OLEDDisplay::flushTx() {
+	while (tx_count_ != 0) {
+		pumpTx(UINT32_MAX);
+	}
+}
+#endif
+
+void OLEDDisplay::advanceCursor() {
+	if (++cursor_column_ >= PanelGeometry::kWidth) {
+		cursor_column_ = 0;
+		cursor_row_ = static_cast<uint8_t>((cursor_row_ + 1) % PanelGeometry::kHeight);
+		cursor_synced_ = false;
+	}
+}
+#endif
+
 void OLEDDisplay::createChar(uint8_t slot, const uint8_t bitmap[8]) {
+#if OLED_TX_QUEUE_SIZE > 0
+	// Cells queued before the upload are drawn with the glyph they were written with.
+	flushTx();
+#endif
 	oled_.createChar(slot, const_cast<uint8_t *>(bitmap));
+	noteWireTimeout();
 }
 
 void OLEDDisplay::command(uint8_t value) {
@@ -65,21 +331,24 @@ void OLEDDisplay::command(uint8_t value) {
 }
 
 void OLEDDisplay::setBacklight(uint8_t level) {
+	oled_.SetBrightness(scaleBrightness(level));
+	noteWireTimeout();
+}
+
+uint8_t OLEDDisplay::scaleBrightness(uint8_t level) {
 	if (level == 0) {
-		oled_.SetBrightness(0);
-		return;
+		return 0;
 	}
 
 	const uint8_t minBrightness = static_cast<uint8_t>(OLED_BRIGHTNESS_MIN);
 	const uint8_t maxBrightness = static_cast<uint8_t>(OLED_BRIGHTNESS_MAX);
 
 	if (maxBrightness <= minBrightness) {
-		oled_.SetBrightness(maxBrightness);
-		return;
+		return maxBrightness;
 	}
 
 	const uint16_t span = static_cast<uint16_t>(maxBrightness - minBrightness);
 	const uint16_t scaled = static_cast<uint16_t>(minBrightness) +
 	                        (static_cast<uint16_t>(level) * span) / 255U;
-	oled_.SetBrightness(static_cast<uint8_t>(scaled));
+	return static_cast<uint8_t>(scaled);
 }
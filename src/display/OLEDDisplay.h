@@ -5,9 +5,10 @@
 
 #include <DisplayConfig.h>
 
+#include "display/DdramGeometry.h"
 #include "display/IDisplay.h"
 
-class OLEDDisplay : public IDisplay {
+class OLEDDisplay final : public IDisplay {
 public:
 	explicit OLEDDisplay(uint8_t resetPin = OLED_RESET_PIN,
 	                     uint8_t i2cAddress = OLED_DEFAULT_I2C_ADDRESS);
@@ -18,16 +19,59 @@ public:
 	void display() override;
 	void setCursor(uint8_t column, uint8_t row) override;
 	size_t write(uint8_t value) override;
+	using IDisplay::write;
 	void createChar(uint8_t slot, const uint8_t bitmap[8]) override;
 	void command(uint8_t value) override;
 	void setBacklight(uint8_t level) override;
+	size_t writeSpan(uint8_t column, uint8_t row, const uint8_t *data, uint8_t length) override;
+	// Blank the cells a lazy clear() left behind that the host has not redrawn.
+	// Called from the host-idle gate; no-op without ENABLE_LAZY_CLEAR.
+	void flushClear();
+	// Queue cell writes instead of sending them (OLED_TX_QUEUE_SIZE > 0).
+	// After disabling, cells keep going through the queue until it is empty.
+	void setTxQueueEnabled(bool enabled);
+	bool txQueueEnabled() const;
+	// Send queued cells for about `budgetUs` (at most one cell over); returns
+	// the microseconds spent.
+	uint32_t pumpTx(uint32_t budgetUs);
+	// I2C transactions abandoned by the Wire timeout since boot (whole bus).
+	static uint16_t i2cTimeouts();
 
 private:
 	uint8_t clampColumn(uint8_t column) const;
 	uint8_t clampRow(uint8_t row) const;
+	static uint8_t scaleBrightness(uint8_t level);
 
 	lcd2oled oled_;
 	uint8_t i2cAddress_;
 	uint8_t columns_ = LCDW;
 	uint8_t rows_ = LCDH;
+#if ENABLE_LAZY_CLEAR
+	bool isStale(uint16_t index) const;
+	void setStale(uint16_t index, bool stale);
+	void advanceCursor();
+	void sendCell(uint16_t index, uint8_t value);
+
+	// What the panel currently shows, plus one bit per cell that a clear()
+	// still owes a blank. Our own cursor model lets redraws of unchanged cells
+	// skip the driver; cursor_synced_ tracks whether lcd2oled agrees with it.
+	char shown_[PanelGeometry::kCells];
+	uint8_t stale_[(PanelGeometry::kCells + 7) / 8];
+	uint16_t stale_count_ = 0;
+	uint8_t cursor_column_ = 0;
+	uint8_t cursor_row_ = 0;
+	bool cursor_synced_ = false;
+#endif
+#if OLED_TX_QUEUE_SIZE > 0
+	void flushTx();
+
+	struct TxCell {
+		uint8_t index; // row-major cell index
+		uint8_t value;
+	};
+	TxCell tx_[OLED_TX_QUEUE_SIZE];
+	uint8_t tx_head_ = 0;
+	uint8_t tx_count_ = 0;
+	bool tx_enabled_ = false;
+#endif
 };
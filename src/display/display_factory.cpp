@@ -1,30 +1,20 @@
 #include "display/display_factory.h"
 
 #include <DisplayConfig.h>
+#include <string.h>
 
 #include "display/HD44780Display.h"
 #include "display/OLEDDisplay.h"
-#include "display/DualDisplay.h"
+#include "display/DisplayMux.h"
+#include "display/FrameBufferDisplay.h"
 
-IDisplay &getDisplay() {
-#if DISPLAY_BACKEND == HD44780
-	static HD44780Display display(
-	    12, // RS
-	    2,  // Enable
-	    3,  // D0
-	    4,  // D1
-	    5,  // D2
-	    6,  // D3
-	    7,  // D4
-	    8,  // D5
-	    9,  // D6
-	    10, // D7
-	    LED_PIN);
-	return display;
-#elif DISPLAY_BACKEND == OLED
-	static OLEDDisplay display;
-	return display;
-#elif DISPLAY_BACKEND == DUAL
+#if ENABLE_FRAME_BUFFER && DISPLAY_BACKEND == DUAL
+#error "ENABLE_FRAME_BUFFER is for single-backend builds; DUAL uses ENABLE_DUAL_QUEUE."
+#endif
+
+namespace {
+#if DISPLAY_BACKEND == HD44780 || DISPLAY_BACKEND == DUAL
+HD44780Display &lcdSink() {
 	static HD44780Display lcd(
 	    12, // RS
 	    2,  // Enable
@@ -37,27 +27,206 @@ IDisplay &getDisplay() {
 	    9,  // D6
 	    10, // D7
 	    LED_PIN);
+	return lcd;
+}
+#endif
+
+#if DISPLAY_BACKEND == OLED || DISPLAY_BACKEND == DUAL
+OLEDDisplay &oledSink() {
 	static OLEDDisplay oled;
-	static DualDisplay display(lcd, oled);
+	return oled;
+}
+#endif
+
+#if DISPLAY_BACKEND == DUAL && defined(OLED2_I2C_ADDRESS)
+OLEDDisplay &oled2Sink() {
+	static OLEDDisplay oled(OLED_RESET_PIN, OLED2_I2C_ADDRESS);
+	return oled;
+}
+
+constexpr uint8_t kSinkCount = 3;
+#elif DISPLAY_BACKEND == DUAL
+constexpr uint8_t kSinkCount = 2;
+#else
+constexpr uint8_t kSinkCount = 1;
+#endif
+
+uint32_t row_refresh_us[kSinkCount] = {0};
+
+#if ENABLE_FRAME_BUFFER
+FrameBufferDisplay &frameBuffer() {
+#if DISPLAY_BACKEND == HD44780
+	static FrameBufferDisplay display(lcdSink(), displayState());
+#else
+	static FrameBufferDisplay display(oledSink(), displayState());
+#endif
 	return display;
+}
+#endif
+
+#if DISPLAY_BACKEND == DUAL
+// Rate cap in RefreshTick ticks (1.024 ms), rounded up so the cap holds.
+#if DEFERRED_SINK_MAX_REFRESH_HZ > 0
+constexpr uint16_t kDeferredRefreshTicks =
+    (1000000UL + DEFERRED_SINK_MAX_REFRESH_HZ * 1024UL - 1) / (DEFERRED_SINK_MAX_REFRESH_HZ * 1024UL);
+#else
+constexpr uint16_t kDeferredRefreshTicks = 0;
+#endif
+
+DisplayMux &displayMux() {
+	static DisplayMux mux(displayState());
+	static bool wired = false;
+	if (!wired) {
+		wired = true;
+		mux.addSink(lcdSink(),
+		            DUAL_DEFER_LCD ? DisplayMux::SinkPolicy::DeferWhenQueueing : DisplayMux::SinkPolicy::Immediate,
+		            kDeferredRefreshTicks);
+		mux.addSink(oledSink(), DisplayMux::SinkPolicy::DeferWhenQueueing, kDeferredRefreshTicks);
+#ifdef OLED2_I2C_ADDRESS
+		mux.addSink(oled2Sink(), DisplayMux::SinkPolicy::DeferWhenQueueing, kDeferredRefreshTicks);
+#endif
+	}
+	return mux;
+}
+#endif
+
+IDisplay &sinkAt(uint8_t sink) {
+#if DISPLAY_BACKEND == HD44780
+	(void)sink;
+	return lcdSink();
+#elif DISPLAY_BACKEND == OLED
+	(void)sink;
+	return oledSink();
+#else
+	return displayMux().sink(sink);
+#endif
+}
+} // namespace
+
+DisplayState &displayState() {
+	static DisplayState state;
+	return state;
+}
+
+ActiveDisplay &getDisplay() {
+#if ENABLE_FRAME_BUFFER
+	return frameBuffer();
+#elif DISPLAY_BACKEND == HD44780
+	return lcdSink();
+#elif DISPLAY_BACKEND == OLED
+	return oledSink();
+#elif DISPLAY_BACKEND == DUAL
+	return displayMux();
 #else
 #error "Selected DISPLAY_BACKEND is not implemented."
 #endif
 }
 
-void serviceDisplayIdleWork() {
+uint32_t serviceDisplayRefresh(uint32_t budgetUs) {
 #if DISPLAY_BACKEND == DUAL
-	auto &display = static_cast<DualDisplay &>(getDisplay());
-	display.pumpSecondary();
+	uint32_t spent = displayMux().pump(budgetUs);
+	if (spent < budgetUs) {
+		spent += oledSink().pumpTx(budgetUs - spent);
+	}
+#ifdef OLED2_I2C_ADDRESS
+	if (spent < budgetUs) {
+		spent += oled2Sink().pumpTx(budgetUs - spent);
+	}
+#endif
+	return spent;
+#elif ENABLE_FRAME_BUFFER
+	return frameBuffer().flush(budgetUs);
 #else
-	// No-op for single-display backends.
+	(void)budgetUs;
+	return 0;
+#endif
+}
+
+void serviceDisplayIdleWork() {
+#if DISPLAY_BACKEND == OLED || DISPLAY_BACKEND == DUAL
+	oledSink().flushClear();
+#endif
+#if DISPLAY_BACKEND == DUAL && defined(OLED2_I2C_ADDRESS)
+	oled2Sink().flushClear();
 #endif
 }
 
 void setDualQueueingEnabled(bool enabled) {
 #if DISPLAY_BACKEND == DUAL
-	static_cast<DualDisplay &>(getDisplay()).setQueueingEnabled(enabled);
+	// Write-through OLED cells go via the transmit queue; deferred ones are
+	// already paced by the mux. Cells still queued drain from pumpTx().
+	oledSink().setTxQueueEnabled(!enabled);
+#ifdef OLED2_I2C_ADDRESS
+	oled2Sink().setTxQueueEnabled(!enabled);
+#endif
+	displayMux().setQueueingEnabled(enabled);
 #else
 	(void)enabled;
 #endif
 }
+
+bool displayRefreshPending() {
+#if DISPLAY_BACKEND == DUAL
+	return displayMux().pendingWrites() != 0;
+#else
+	return false;
+#endif
+}
+
+uint16_t displayI2cTimeouts() {
+#if DISPLAY_BACKEND == OLED || DISPLAY_BACKEND == DUAL
+	return OLEDDisplay::i2cTimeouts();
+#else
+	return 0;
+#endif
+}
+
+uint8_t displaySinkCount() {
+	return kSinkCount;
+}
+
+const __FlashStringHelper *displaySinkName(uint8_t sink) {
+#if DISPLAY_BACKEND == OLED
+	(void)sink;
+	return F("OLED");
+#else
+	return sink == 0 ? F("LCD") : sink == 1 ? F("OLED") : F("OLED2");
+#endif
+}
+
+uint32_t displayRowRefreshUs(uint8_t sink) {
+	return sink < kSinkCount ? row_refresh_us[sink] : 0;
+}
+
+void calibrateDisplayRefresh() {
+	// Write the sinks directly (not through the mux) so each panel's cost
+	// is measured on its own, independent of the streaming mode.
+	uint8_t blank[LCDW];
+	memset(blank, ' ', sizeof(blank));
+#if DISPLAY_BACKEND == DUAL
+	// Time the real I2C transfer, not enqueueing into the OLED transmit queue
+	// (empty right after begin(), so the writes below go straight out).
+	const bool tx_queued = oledSink().txQueueEnabled();
+	oledSink().setTxQueueEnabled(false);
+#ifdef OLED2_I2C_ADDRESS
+	oled2Sink().setTxQueueEnabled(false);
+#endif
+#endif
+	for (uint8_t sink = 0; sink < kSinkCount; ++sink) {
+		IDisplay &target = sinkAt(sink);
+		const uint32_t start = micros();
+		target.writeSpan(0, 0, blank, LCDW);
+		row_refresh_us[sink] = micros() - start;
+#if DISPLAY_BACKEND == DUAL
+		displayMux().setRowCostUs(sink, row_refresh_us[sink]);
+#elif ENABLE_FRAME_BUFFER
+		frameBuffer().setRowCostUs(row_refresh_us[sink]);
+#endif
+	}
+#if DISPLAY_BACKEND == DUAL
+	oledSink().setTxQueueEnabled(tx_queued);
+#ifdef OLED2_I2C_ADDRESS
+	oled2Sink().setTxQueueEnabled(tx_queued);
+#endif
+#endif
+}
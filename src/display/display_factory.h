@@ -1,7 +1,34 @@
 #pragma once
 
+#include <Arduino.h>
+
+#include "display/ActiveDisplay.h"
+#include "display/DisplayState.h"
 #include "display/IDisplay.h"
 
-IDisplay &getDisplay();
+// Concrete type per build (see ActiveDisplay.h) so callers dispatch statically.
+ActiveDisplay &getDisplay();
+// Shared text grid + glyph bank referenced by the whole display stack.
+DisplayState &displayState();
+// Budgeted catch-up of deferred display state (frame buffer diff, deferred
+// mux sinks), split into sub-row chunks. Safe to call while the host is
+// still streaming; returns the microseconds spent.
+uint32_t serviceDisplayRefresh(uint32_t budgetUs);
+// Work that is not chunked (lazy-clear blanking); run only once the host
+// has gone quiet.
 void serviceDisplayIdleWork();
 void setDualQueueingEnabled(bool enabled);
+// True while a deferred sink still lags the shared frame.
+bool displayRefreshPending();
+// I2C transactions abandoned by the Wire timeout (0 without an OLED).
+uint16_t displayI2cTimeouts();
+
+// Per-sink (physical panel) introspection for the GET_CAPS meta reply.
+uint8_t displaySinkCount();
+const __FlashStringHelper *displaySinkName(uint8_t sink);
+// Cost of repainting one full LCDW-wide row on the sink, measured by
+// calibrateDisplayRefresh(); 0 until measured.
+uint32_t displayRowRefreshUs(uint8_t sink);
+// Times a full-row write on every sink. Call once after begin(), before the
+// startup banner (it leaves row 0 blank).
+void calibrateDisplayRefresh();
@@ -1,15 +1,22 @@
 #include <Arduino.h>
 #include <avr/io.h>
+#include <util/crc16.h>
 #include <util/delay.h>
 #include <stdio.h>
 #include <string.h>
 
 #include <DisplayConfig.h>
 
+#include "HostSerial.h"
+#include "RefreshTick.h"
 #include "SerialDebug.h"
 #include "display/display_factory.h"
 
-#if DISPLAY_BACKEND != HD44780
+// HD44780 builds pass 0xFE commands straight to the controller unless a frame
+// buffer sits in front of it, which needs the translator's cursor model.
+#define USE_COMMAND_TRANSLATOR (DISPLAY_BACKEND != HD44780 || ENABLE_FRAME_BUFFER)
+
+#if USE_COMMAND_TRANSLATOR
 #include "display/Hd44780CommandTranslator.h"
 #endif
 
@@ -23,23 +30,72 @@
 #define DEBUG_LOG(msg) do {} while (0)
 #endif
 
-byte cmd; //will hold our sent command
-
-static IDisplay &display = getDisplay();
+static ActiveDisplay &display = getDisplay();
 static bool host_active = false;
 static bool startup_screen_visible = false;
 static bool pending_host_active_report = false;
 static uint8_t streaming_mode = STREAMING_MODE_DEFAULT;
 static bool pending_streaming_mode_report = false;
+static bool adaptive_deferring = false; // Adaptive mode is currently shadowing
 #if ENABLE_SERIAL_DEBUG
+static uint16_t adaptive_switches = 0;
+#endif
 static uint32_t last_rx_micros = 0;
 static constexpr uint32_t HOST_IDLE_BEFORE_LOG_US = 20000; // 20ms of quiet = burst finished at 57,600 bps
+// Ring slots kept out of the display-refresh budget to cover loop overhead
+// and the ISR latency of a refresh chunk that overruns its estimate.
+static constexpr uint16_t REFRESH_BUDGET_RESERVE_BYTES = 16;
+#ifdef STREAMING_ADAPTIVE_HIGH_WATER
+static uint16_t adaptive_high_water = STREAMING_ADAPTIVE_HIGH_WATER;
+#else
+static uint16_t adaptive_high_water = 0; // set by update_adaptive_high_water()
+#endif
+
+// Adaptive mode only checks the ring between drain passes, and one
+// write-through row cannot be interrupted, so deferring must start while
+// the ring can still absorb a full row on every sink at the current baud.
+static void update_adaptive_high_water() {
+#ifndef STREAMING_ADAPTIVE_HIGH_WATER
+	if (HostSerial.baud() == 0) {
+		return;
+	}
+	uint32_t row_us = 0;
+	for (uint8_t sink = 0; sink < displaySinkCount(); ++sink) {
+		row_us += displayRowRefreshUs(sink);
+	}
+	const uint32_t byte_us = 10000000UL / HostSerial.baud();
+	const uint32_t row_bytes = (row_us + byte_us - 1) / byte_us + REFRESH_BUDGET_RESERVE_BYTES;
+	const uint16_t capacity = HostSerial.capacity();
+	adaptive_high_water = row_bytes < capacity ? static_cast<uint16_t>(capacity - row_bytes) : 0;
+#endif
+}
+#if ENABLE_SERIAL_DEBUG
 static uint16_t rx_bytes_total = 0;
 static uint16_t rx_bytes_since_boot = 0;
+// Longest gap between display-refresh dispatches, in RefreshTick ticks; the
+// worst-case delay before a deferred write starts reaching the panel.
+static uint16_t refresh_last_dispatch_tick = 0;
+static uint16_t refresh_max_gap_ticks = 0;
 #endif
 
 #if ENABLE_SERIAL_DEBUG
 static void emit_boot_diagnostics();
+
+static void emit_rx_ring_stats() {
+	const HostSerialPort::Stats stats = HostSerial.stats();
+	SerialDebug::kv(true, F("rx.ring.size"), HostSerial.capacity());
+	SerialDebug::kv(true, F("rx.ring.high_water"), stats.high_water);
+	SerialDebug::kv(true, F("rx.ring.dropped"), stats.dropped);
+	SerialDebug::kv(true, F("rx.uart.received"), stats.bytes_received);
+	SerialDebug::kv(true, F("rx.uart.overruns"), stats.overruns);
+	SerialDebug::kv(true, F("rx.uart.framing_errors"), stats.framing_errors);
+	SerialDebug::kv(true, F("refresh.tick.max_gap"), refresh_max_gap_ticks);
+	SerialDebug::kv(true, F("streaming.adaptive.switches"), adaptive_switches);
+	SerialDebug::kv(true, F("streaming.adaptive.high_water"), adaptive_high_water);
+	SerialDebug::kv(true, F("oled.i2c.timeouts"), displayI2cTimeouts());
+	refresh_max_gap_ticks = 0;
+}
+
 static void maybe_enable_serial_debug_when_idle() {
 	// If a previous burst left SerialDebug muted, re-enable it once the RX line
 	// has been quiet long enough that printing won't cause an overrun.
@@ -49,7 +105,7 @@ static void maybe_enable_serial_debug_when_idle() {
 	if (SerialDebug::isRuntimeEnabled()) {
 		return;
 	}
-	if (Serial.available() != 0) {
+	if (HostSerial.available() != 0) {
 		return;
 	}
 	if ((micros() - last_rx_micros) <= HOST_IDLE_BEFORE_LOG_US) {
@@ -69,7 +125,7 @@ static void maybe_emit_host_active_report() {
 	if (rx_bytes_since_boot < 16) {
 		return;
 	}
-	if (Serial.available() != 0) {
+	if (HostSerial.available() != 0) {
 		return;
 	}
 	if ((micros() - last_rx_micros) <= HOST_IDLE_BEFORE_LOG_US) {
@@ -77,18 +133,28 @@ static void maybe_emit_host_active_report() {
 	}
 
 	SerialDebug::setRuntimeEnabled(true);
-	Serial.println(F("raw: host active"));
+	HostSerial.println(F("raw: host active"));
 	SerialDebug::kv(true, F("rx.bytes_total"), rx_bytes_total);
 	SerialDebug::kv(true, F("rx.bytes_since_boot"), rx_bytes_since_boot);
+	emit_rx_ring_stats();
 	emit_boot_diagnostics();
 	SerialDebug::line(true, F("serial_debug: host active"));
 	pending_host_active_report = false;
 }
 #endif
 
+static const __FlashStringHelper *streaming_mode_name() {
+	return streaming_mode == STREAMING_MODE_SAFE       ? F("safe")
+	       : streaming_mode == STREAMING_MODE_ADAPTIVE ? F("adaptive")
+	                                                   : F("immediate");
+}
+
 static void apply_streaming_mode(bool announce_if_changed) {
-	const bool safe = streaming_mode == STREAMING_MODE_SAFE;
-	setDualQueueingEnabled(safe);
+	// Adaptive starts out deferring, so the startup-screen clear and the head
+	// of the first burst are shadowed; service_adaptive_streaming() returns
+	// to write-through once the ring has drained.
+	adaptive_deferring = streaming_mode == STREAMING_MODE_ADAPTIVE;
+	setDualQueueingEnabled(streaming_mode != STREAMING_MODE_IMMEDIATE);
 	if (announce_if_changed) {
 		pending_streaming_mode_report = true;
 	}
@@ -99,7 +165,7 @@ static void maybe_emit_streaming_mode_report() {
 	if (!pending_streaming_mode_report) {
 		return;
 	}
-	if (Serial.available() != 0) {
+	if (HostSerial.available() != 0) {
 		return;
 	}
 	if ((micros() - last_rx_micros) <= HOST_IDLE_BEFORE_LOG_US) {
@@ -107,19 +173,39 @@ static void maybe_emit_streaming_mode_report() {
 	}
 	SerialDebug::setRuntimeEnabled(true);
 	SerialDebug::printPrefix();
-	Serial.print(F("mode.streaming="));
-	Serial.println(streaming_mode == STREAMING_MODE_SAFE ? F("safe") : F("immediate"));
+	HostSerial.print(F("mode.streaming="));
+	HostSerial.println(streaming_mode_name());
 	pending_streaming_mode_report = false;
 }
 #endif
 
+#if USE_COMMAND_TRANSLATOR
+static Hd44780CommandTranslator command_translator(display, displayState());
+#endif
+
 #if DISPLAY_BACKEND != HD44780
-static Hd44780CommandTranslator command_translator(display);
+// On OLED the backlight byte becomes an SSD1306 contrast transaction over I2C,
+// so host brightness ramps are recorded here and only the latest level is
+// applied from the refresh tick, budget permitting, or once per idle window
+// (HD44780 PWM stays immediate).
+static bool backlight_pending = false;
+static uint8_t backlight_level = STARTUP_BRIGHTNESS;
+// One contrast command is address + control + 0x81 + level, ~360 us at
+// 100 kHz; allow for a second OLED on the bus.
+static constexpr uint32_t BACKLIGHT_APPLY_COST_US = 800;
+
+static void service_pending_backlight() {
+	if (!backlight_pending) {
+		return;
+	}
+	backlight_pending = false;
+	display.setBacklight(backlight_level);
+}
 #endif
 
 #if ENABLE_SERIAL_DEBUG
-static constexpr uint16_t SERIAL_WAIT_LOG_THRESHOLD_US = 500;
-static constexpr uint8_t SERIAL_BACKLOG_LOW_WATER = 8;
+static constexpr uint16_t SERIAL_BATCH_LOG_THRESHOLD_US = 500;
+static constexpr uint8_t SERIAL_BATCH_LOG_MIN_BACKLOG = 8;
 
 static int16_t free_sram() {
 	extern char __heap_start;
@@ -212,17 +298,18 @@ static void dismiss_startup_screen() {
 }
 
 void setup() {
-	Serial.begin(BAUDRATE);
+	HostSerial.begin(BAUDRATE);
+	RefreshTick.begin();
 
-	Serial.print(F("ENABLE_SERIAL_DEBUG:"));
-	Serial.println(ENABLE_SERIAL_DEBUG);
+	HostSerial.print(F("ENABLE_SERIAL_DEBUG:"));
+	HostSerial.println(ENABLE_SERIAL_DEBUG);
 
-	Serial.print(F("ENABLE_VERBOSE_DEBUG_LOGS:"));
-	Serial.println(ENABLE_VERBOSE_DEBUG_LOGS);	
+	HostSerial.print(F("ENABLE_VERBOSE_DEBUG_LOGS:"));
+	HostSerial.println(ENABLE_VERBOSE_DEBUG_LOGS);	
 
 #if ENABLE_SERIAL_DEBUG
 	SerialDebug::setRuntimeEnabled(true);
-	Serial.println(F("debug: instrumentation armed"));
+	HostSerial.println(F("debug: instrumentation armed"));
 #endif
 	setDualQueueingEnabled(false);
 	DEBUG_LOG("setup: serial online");
@@ -243,80 +330,83 @@ void setup() {
 	DEBUG_LOG("setup: backlight set");
 	display.display();
 	DEBUG_LOG("setup: display() called");
-#if DISPLAY_BACKEND != HD44780
+	calibrateDisplayRefresh();
+	update_adaptive_high_water();
+#if USE_COMMAND_TRANSLATOR
 	command_translator.reset();
 #endif
 	display_startup_screen();
 	DEBUG_LOG("setup: startup banner drawn");
 #if ENABLE_SERIAL_DEBUG
-	Serial.print(F("debug: free_sram.after_banner="));
-	Serial.println(free_sram());
+	HostSerial.print(F("debug: free_sram.after_banner="));
+	HostSerial.println(free_sram());
 #endif
 	// Ensure any deferred OLED bytes drain before we start servicing the host.
+	serviceDisplayRefresh(UINT32_MAX);
 	serviceDisplayIdleWork();
-}
-
-int serial_read() {
-	int result = -1;
 #if ENABLE_SERIAL_DEBUG
-	const uint32_t wait_start = micros();
-	uint16_t spins = 0;
-#endif
-	while(result == -1) {
-		if(Serial.available() > 0) {
-			result = Serial.read();
-#if ENABLE_SERIAL_DEBUG
-			++rx_bytes_total;
-			++rx_bytes_since_boot;
-			last_rx_micros = micros();
-			// Always suppress debug logging while bytes are actively arriving.
-			// Otherwise a prior idle-triggered banner (e.g., after a short meta
-			// command) can leave logging enabled during the next burst and cause
-			// us to overrun RX again.
-			if (host_active) {
-				SerialDebug::setRuntimeEnabled(false);
-			}
+	refresh_last_dispatch_tick = RefreshTick.now();
 #endif
-		}
-#if ENABLE_SERIAL_DEBUG
-		else {
-			maybe_enable_serial_debug_when_idle();
-			maybe_emit_host_active_report();
-			maybe_emit_streaming_mode_report();
-			// Only run deferred display work once the RX stream has been quiet long
-			// enough that we won't overflow the UART RX buffer. Running I2C/LCD
-			// refresh work in the tiny gaps between bytes can block long enough to
-			// drop the tail of unpaced bursts (especially after short meta commands).
-			if (!host_active || (micros() - last_rx_micros) > HOST_IDLE_BEFORE_LOG_US) {
-				serviceDisplayIdleWork();
-			}
-			++spins;
-		}
-#else
-		else {
-			if (!host_active || (micros() - last_rx_micros) > HOST_IDLE_BEFORE_LOG_US) {
-				serviceDisplayIdleWork();
-			}
-		}
-#endif
-	}
-#if ENABLE_SERIAL_DEBUG
-	const uint32_t wait_us = micros() - wait_start;
-	const int backlog = Serial.available();
-	if (SerialDebug::isRuntimeEnabled() &&
-	    (wait_us > SERIAL_WAIT_LOG_THRESHOLD_US || backlog < SERIAL_BACKLOG_LOW_WATER)) {
-		SerialDebug::printPrefix();
-		Serial.print(F("serial.byte wait_us="));
-		Serial.print(wait_us);
-		Serial.print(F(" spins="));
-		Serial.print(spins);
-		Serial.print(F(" backlog="));
-		Serial.println(backlog);
-	}
-#endif
-	return result;
 }
 
+// los-panel parser state. Multi-byte sequences are resumable so a sequence
+// split across RX batches simply continues on the next drain pass.
+enum class HostParserState : uint8_t {
+	Idle,              // next byte is a prefix or display data
+	Command,           // after 0xFE: HD44780 instruction byte
+	Backlight,         // after 0xFD: backlight level
+	Meta,              // after 0xFC: ArduLCDpp sub-command
+	MetaStreamingMode, // after 0xFC 0x10: streaming mode
+	MetaSetBaud,       // after 0xFC 0x20: proposed baud code
+	MetaFlowControl,   // after 0xFC 0x30: flow-control mode
+	MetaRegionRow,     // after 0xFC 0x40: region row
+	MetaRegionColumn,  // region column
+	MetaRegionLength,  // region payload length
+	MetaRegionData,    // region payload bytes
+	MetaFramedSequence, // after 0xFC 0x60: sequence number, then region fields
+	MetaFramedCrc,     // trailing CRC-8 of a framed region
+	MetaFrameOp,       // after 0xFC 0x50: next frame-update op
+	MetaFrameCopy,     // literal cells of a COPY op
+	MetaFrameRepeat,   // the cell value of a REPEAT op
+};
+
+// ArduLCDpp meta sub-commands (second byte after 0xFC).
+static constexpr uint8_t META_GET_INFO = 0x01;
+static constexpr uint8_t META_GET_CAPS = 0x02;
+static constexpr uint8_t META_SET_STREAMING_MODE = 0x10;
+static constexpr uint8_t META_SET_BAUD = 0x20;
+static constexpr uint8_t META_CONFIRM_BAUD = 0x21;
+static constexpr uint8_t META_SET_FLOW_CONTROL = 0x30;
+static constexpr uint8_t META_WRITE_REGION = 0x40;
+static constexpr uint8_t META_FRAME_UPDATE = 0x50;
+static constexpr uint8_t META_FRAMED_REGION = 0x60;
+
+#if ENABLE_REGION_OPS
+// Bulk region write (`FC 40 <row> <col> <len> <bytes...>`). The payload is
+// collected here and handed to the display path as one span; bytes past the
+// row end are consumed but dropped.
+static uint8_t region_row = 0;
+static uint8_t region_column = 0;
+static uint8_t region_expected = 0;
+static uint8_t region_received = 0;
+static uint8_t region_payload[LCDW];
+
+// Framed region write (`FC 60 <seq> <row> <col> <len> <bytes...> <crc8>`):
+// same fields as FC 40, applied only if the CRC-8 (poly 0x07, init 0, over
+// seq..bytes) matches. Every frame is answered with `ack=<seq>` or
+// `nak=<seq>` so the host can retransmit just the damaged rows. A frame left
+// incomplete for FRAMED_REGION_TIMEOUT_US (lost bytes) is NAKed and dropped.
+// Framing is stop-and-wait (one frame in flight, GET_CAPS `framed_window=1`):
+// payload bytes are arbitrary, so an `FC 60` inside a frame cannot be told
+// from a new header, and resync relies on the host pausing for the reply.
+static bool region_framed = false;
+static uint8_t region_sequence = 0;
+static uint8_t region_crc = 0;
+static constexpr uint32_t FRAMED_REGION_TIMEOUT_US = 20000;
+#endif
+
+static HostParserState parser_state = HostParserState::Idle;
+
 /**
  * From : https://github.com/lcdproc/lcdproc/blob/master/server/drivers.c
  * All the serial connections supported by driver
@@ -339,60 +429,711 @@ https://github.com/lcdproc/lcdproc/blob/master/server/drivers/hd44780-serial.c
 https://lcdproc.sourceforge.net/docs/lcdproc-0-5-6-user.html#los-panel
 */
 
-void loop() {
-	cmd = serial_read();
-	if (!host_active) {
-		host_active = true;
+static void mark_host_active() {
+	host_active = true;
 #if ENABLE_SERIAL_DEBUG
-		// Important: do not emit verbose serial logs while the host may still be
-		// streaming a burst, otherwise we can block long enough to overrun the
-		// UART RX buffer and lose the tail bytes we are trying to process.
-		SerialDebug::setRuntimeEnabled(false);
-		rx_bytes_since_boot = 0;
-		pending_host_active_report = true;
+	// Important: do not emit verbose serial logs while the host may still be
+	// streaming a burst, otherwise we can block long enough to overrun the
+	// UART RX buffer and lose the tail bytes we are trying to process.
+	SerialDebug::setRuntimeEnabled(false);
+	rx_bytes_since_boot = 0;
+	pending_host_active_report = true;
 #else
-		SerialDebug::setRuntimeEnabled(true);
-#endif
-		apply_streaming_mode(false);
-		dismiss_startup_screen();
-	}
-	// Note: host-active reporting is emitted from the `serial_read()` idle loop
-	// so we still report even when the host stops sending bytes.
-	switch(cmd) {
-			case 0xFC: {
-				// ArduLCDpp meta/control prefix (reserved).
-				const uint8_t subcmd = static_cast<uint8_t>(serial_read());
-				if (subcmd == 0x10) { // SET_STREAMING_MODE
-					const uint8_t mode = static_cast<uint8_t>(serial_read());
-					const uint8_t normalized = mode ? STREAMING_MODE_SAFE : STREAMING_MODE_IMMEDIATE;
-					if (streaming_mode != normalized) {
-						streaming_mode = normalized;
-						apply_streaming_mode(true);
-					}
-				}
-				break;
-			}
-			case 0xFE:
+	SerialDebug::setRuntimeEnabled(true);
+#endif
+	apply_streaming_mode(false);
+	dismiss_startup_screen();
+}
+
+// Meta replies are single newline-terminated ASCII lines so host tools can
+// pick them out of any interleaved debug output.
+static void begin_meta_reply() {
+	HostSerial.print(F("@ARDULCDPP "));
+}
+
+// Baud codes for `FC 20 <code>`. All of these divide 16 MHz cleanly with U2X
+// (115200 is the usual +2.1% compromise, same as HardwareSerial).
+static uint32_t baud_for_code(uint8_t code) {
+	switch (code) {
+		case 0:
+			return 57600UL;
+		case 1:
+			return 115200UL;
+		case 2:
+			return 250000UL;
+		case 3:
+			return 500000UL;
+		case 4:
+			return 1000000UL;
+		default:
+			return 0;
+	}
+}
+
+// Protocol version of the GET_INFO/GET_CAPS replies; bump when keys change.
+static constexpr uint8_t META_PROTO_VERSION = 1;
+
+static const __FlashStringHelper *backend_name() {
 #if DISPLAY_BACKEND == HD44780
-				display.command(serial_read());
+	return F("HD44780");
+#elif DISPLAY_BACKEND == OLED
+	return F("OLED");
 #else
-				command_translator.handleCommand(static_cast<uint8_t>(serial_read()));
-#endif
-				break;
-			case 0xFD:
-				// backlight control
-				display.setBacklight(serial_read());
-				break;
-			default:
+	return F("DUAL");
+#endif
+}
+
+static const __FlashStringHelper *mcu_name() {
+#if defined(__AVR_ATmega168__)
+	return F("atmega168");
+#elif defined(__AVR_ATmega328P__)
+	return F("atmega328p");
+#elif defined(__AVR_ATmega2560__)
+	return F("atmega2560");
+#else
+	return F("unknown");
+#endif
+}
+
+static void reply_info() {
+	begin_meta_reply();
+	HostSerial.print(F("proto="));
+	HostSerial.print(META_PROTO_VERSION);
+	HostSerial.print(F(" fw=" ARDULCDPP_VERSION " sha=" ARDULCDPP_GIT_SHA " env=" ARDULCDPP_ENV " backend="));
+	HostSerial.print(backend_name());
+	HostSerial.print(F(" geom="));
+	HostSerial.print(LCDW);
+	HostSerial.print('x');
+	HostSerial.print(LCDH);
+	HostSerial.print(F(" mcu="));
+	HostSerial.print(mcu_name());
+	HostSerial.print(F(" baud="));
+	HostSerial.println(HostSerial.baud());
+}
+
+// Performance limits so host tools can size chunks, pick opcodes and pace
+// from real device numbers instead of hard-coded delays.
+static void reply_caps() {
+	begin_meta_reply();
+	HostSerial.print(F("proto="));
+	HostSerial.print(META_PROTO_VERSION);
+	HostSerial.print(F(" rx_buf="));
+	HostSerial.print(HostSerial.capacity());
+	HostSerial.print(F(" bauds="));
+	for (uint8_t code = 0; baud_for_code(code) != 0; ++code) {
+		const uint32_t baud = baud_for_code(code);
+		if (baud > BAUDRATE_MAX) {
+			break;
+		}
+		if (code != 0) {
+			HostSerial.print(',');
+		}
+		HostSerial.print(baud);
+	}
+	HostSerial.print(F(" mode="));
+	HostSerial.print(streaming_mode_name());
+#if ENABLE_REGION_OPS
+	HostSerial.print(F(" flow=credit ops=region,frame,framed framed_window=1 max_span="));
+#else
+	HostSerial.print(F(" flow=credit ops=none max_span="));
+#endif
+	HostSerial.print(LCDW);
+	HostSerial.print(F(" idle_us="));
+	HostSerial.print(HOST_IDLE_BEFORE_LOG_US);
+	HostSerial.print(F(" row_us="));
+	for (uint8_t sink = 0; sink < displaySinkCount(); ++sink) {
+		if (sink != 0) {
+			HostSerial.print(',');
+		}
+		HostSerial.print(displaySinkName(sink));
+		HostSerial.print(':');
+		HostSerial.print(displayRowRefreshUs(sink));
+	}
+	HostSerial.println();
+}
+
+static bool baud_confirm_pending = false;
+static uint32_t baud_switch_millis = 0;
+
+// Credit-based flow control (`FC 30 01`). The device grants the host a byte
+// window that always fits in the free RX ring space and returns credit as the
+// parser consumes bytes, so a host that honors the window can stream unpaced
+// without drops in either streaming mode. Grants are incremental.
+static bool flow_control_enabled = false;
+static uint16_t flow_credit_owed = 0; // bytes consumed since the last grant
+static constexpr uint16_t FLOW_CREDIT_BATCH = (SERIAL_RX_RING_SIZE - 1) / 4;
+static constexpr uint32_t FLOW_CREDIT_IDLE_US = 1000;
+
+static void send_flow_credit(uint16_t credit) {
+	begin_meta_reply();
+	HostSerial.print(F("credit="));
+	HostSerial.println(credit);
+}
+
+static void set_flow_control(bool enabled) {
+	if (enabled && flow_control_enabled) {
+		// Already on: the host still holds its unspent window, so a fresh one
+		// could overrun the ring. Acknowledge with just the owed credit.
+		send_flow_credit(flow_credit_owed);
+		flow_credit_owed = 0;
+		return;
+	}
+	flow_control_enabled = enabled;
+	flow_credit_owed = 0;
+	if (!enabled) {
+		begin_meta_reply();
+		HostSerial.println(F("flow=off"));
+		return;
+	}
+	// Anything already queued has not been credited; leave room for it.
+	send_flow_credit(static_cast<uint16_t>(HostSerial.capacity() - HostSerial.available()));
+}
+
+static void service_flow_credit() {
+	if (!flow_control_enabled || flow_credit_owed == 0) {
+		return;
+	}
+	// Return credit in batches while the host is streaming, and return the
+	// remainder once it goes quiet (it may be waiting on exactly that credit).
+	if (flow_credit_owed < FLOW_CREDIT_BATCH &&
+	    (HostSerial.available() != 0 || (micros() - last_rx_micros) < FLOW_CREDIT_IDLE_US)) {
+		return;
+	}
+	send_flow_credit(flow_credit_owed);
+	flow_credit_owed = 0;
+}
+
+static void switch_host_baud(uint32_t baud) {
+	// Let the acknowledgement leave at the old rate before reprogramming UBRR.
+	HostSerial.flush();
+	HostSerial.begin(baud);
+	parser_state = HostParserState::Idle;
+	// begin() resets the RX ring, so outstanding credit is meaningless now;
+	// hosts re-enable flow control after confirming the new rate.
+	flow_control_enabled = false;
+	flow_credit_owed = 0;
+	update_adaptive_high_water();
+}
+
+static void handle_set_baud_byte(uint8_t code) {
+	parser_state = HostParserState::Idle;
+	const uint32_t baud = baud_for_code(code);
+	if (baud == 0 || baud > BAUDRATE_MAX) {
+		begin_meta_reply();
+		HostSerial.println(F("err=bad_baud"));
+		return;
+	}
+	begin_meta_reply();
+	HostSerial.print(F("baud="));
+	HostSerial.print(baud);
+	HostSerial.println(F(" ok"));
+	if (baud == HostSerial.baud()) {
+		return;
+	}
+	switch_host_baud(baud);
+	// Anything other than BAUDRATE must be confirmed at the new rate, otherwise
+	// a host that never switched would lose the link for good.
+	baud_confirm_pending = baud != BAUDRATE;
+	baud_switch_millis = millis();
+}
+
+static void handle_confirm_baud() {
+	parser_state = HostParserState::Idle;
+	baud_confirm_pending = false;
+	begin_meta_reply();
+	HostSerial.print(F("baud="));
+	HostSerial.print(HostSerial.baud());
+	HostSerial.println(F(" confirmed"));
+}
+
+static void service_baud_fallback() {
+	if (!baud_confirm_pending) {
+		return;
+	}
+	if ((millis() - baud_switch_millis) < BAUD_CONFIRM_TIMEOUT_MS) {
+		return;
+	}
+	baud_confirm_pending = false;
+	switch_host_baud(BAUDRATE);
+	begin_meta_reply();
+	HostSerial.print(F("baud="));
+	HostSerial.print(static_cast<uint32_t>(BAUDRATE));
+	HostSerial.println(F(" fallback"));
+}
+
+#if ENABLE_REGION_OPS
+static void apply_region_write() {
+	const uint8_t length = region_received < sizeof(region_payload) ? region_received : sizeof(region_payload);
+#if !USE_COMMAND_TRANSLATOR
+	if (region_row >= LCDH || region_column >= LCDW) {
+		return;
+	}
+	const uint8_t room = static_cast<uint8_t>(LCDW - region_column);
+	display.writeSpan(region_column, region_row, region_payload, length < room ? length : room);
+#else
+	command_translator.writeRegion(region_row, region_column, region_payload, length);
+#endif
+}
+
+static void reply_framed_region(bool accepted) {
+	begin_meta_reply();
+	HostSerial.print(accepted ? F("ack=") : F("nak="));
+	HostSerial.println(region_sequence);
+}
+
+static void finish_region() {
+	if (region_framed) {
+		parser_state = HostParserState::MetaFramedCrc;
+		return;
+	}
+	apply_region_write();
+	parser_state = HostParserState::Idle;
+}
+
+static void handle_framed_crc_byte(uint8_t value) {
+	const bool accepted = value == region_crc;
+	if (accepted) {
+		apply_region_write();
+	}
+	region_framed = false;
+	parser_state = HostParserState::Idle;
+	reply_framed_region(accepted);
+}
+
+static void service_framed_region_timeout() {
+	if (!region_framed || (micros() - last_rx_micros) < FRAMED_REGION_TIMEOUT_US) {
+		return;
+	}
+	region_framed = false;
+	parser_state = HostParserState::Idle;
+	reply_framed_region(false);
+}
+
+static void handle_region_byte(uint8_t value) {
+	if (region_framed) {
+		region_crc = _crc8_ccitt_update(region_crc, value);
+	}
+	switch (parser_state) {
+		case HostParserState::MetaFramedSequence:
+			region_sequence = value;
+			parser_state = HostParserState::MetaRegionRow;
+			break;
+		case HostParserState::MetaRegionRow:
+			region_row = value;
+			parser_state = HostParserState::MetaRegionColumn;
+			break;
+		case HostParserState::MetaRegionColumn:
+			region_column = value;
+			parser_state = HostParserState::MetaRegionLength;
+			break;
+		case HostParserState::MetaRegionLength:
+			region_expected = value;
+			region_received = 0;
+			if (value) {
+				parser_state = HostParserState::MetaRegionData;
+			} else {
+				finish_region();
+			}
+			break;
+		default:
+			if (region_received < sizeof(region_payload)) {
+				region_payload[region_received] = value;
+			}
+			++region_received;
+			if (region_received == region_expected) {
+				finish_region();
+			}
+			break;
+	}
+}
+
+// Frame update (`FC 50 <ops...>`): a diff against what is already on the
+// display, walked row-major over the LCDW x LCDH grid starting at (0,0).
+// Op byte: 00nnnnnn SKIP n+1 cells, 01nnnnnn COPY n+1 literal cells,
+// 10nnnnnn REPEAT the next byte n+1 times, 11xxxxxx END (0xC0).
+// Consecutive written cells on one row are batched into a single region write.
+static constexpr uint8_t FRAME_CELLS = LCDW * LCDH;
+static constexpr uint8_t FRAME_OP_MASK = 0xC0;
+static constexpr uint8_t FRAME_OP_SKIP = 0x00;
+static constexpr uint8_t FRAME_OP_COPY = 0x40;
+static constexpr uint8_t FRAME_OP_REPEAT = 0x80;
+static_assert(LCDW * LCDH <= 255, "frame updates index cells with a uint8_t");
+
+static uint8_t frame_cell = 0;
+static uint8_t frame_run_remaining = 0;
+
+static void flush_frame_span() {
+	if (region_received == 0) {
+		return;
+	}
+	apply_region_write();
+	region_received = 0;
+}
+
+static void put_frame_cell(uint8_t value) {
+	if (frame_cell >= FRAME_CELLS) {
+		return;
+	}
+	const uint8_t row = static_cast<uint8_t>(frame_cell / LCDW);
+	const uint8_t column = static_cast<uint8_t>(frame_cell % LCDW);
+	if (region_received != 0 && (row != region_row || column != region_column + region_received)) {
+		flush_frame_span();
+	}
+	if (region_received == 0) {
+		region_row = row;
+		region_column = column;
+	}
+	region_payload[region_received++] = value;
+	++frame_cell;
+	if (column == LCDW - 1) {
+		flush_frame_span();
+	}
+}
+
+static void begin_frame_update() {
+	frame_cell = 0;
+	frame_run_remaining = 0;
+	region_received = 0;
+	parser_state = HostParserState::MetaFrameOp;
+}
+
+static void handle_frame_byte(uint8_t value) {
+	switch (parser_state) {
+		case HostParserState::MetaFrameOp: {
+			const uint8_t count = static_cast<uint8_t>((value & ~FRAME_OP_MASK) + 1);
+			switch (value & FRAME_OP_MASK) {
+				case FRAME_OP_SKIP:
+					flush_frame_span();
+					frame_cell = (FRAME_CELLS - frame_cell) > count ? static_cast<uint8_t>(frame_cell + count) : FRAME_CELLS;
+					break;
+				case FRAME_OP_COPY:
+					frame_run_remaining = count;
+					parser_state = HostParserState::MetaFrameCopy;
+					break;
+				case FRAME_OP_REPEAT:
+					frame_run_remaining = count;
+					parser_state = HostParserState::MetaFrameRepeat;
+					break;
+				default:
+					flush_frame_span();
+					parser_state = HostParserState::Idle;
+					break;
+			}
+			break;
+		}
+		case HostParserState::MetaFrameCopy:
+			put_frame_cell(value);
+			if (--frame_run_remaining == 0) {
+				parser_state = HostParserState::MetaFrameOp;
+			}
+			break;
+		default:
+			while (frame_run_remaining != 0) {
+				put_frame_cell(value);
+				--frame_run_remaining;
+			}
+			parser_state = HostParserState::MetaFrameOp;
+			break;
+	}
+}
+#endif
+
+static void handle_meta_byte(uint8_t value) {
+	// ArduLCDpp meta/control prefix (reserved). Unknown sub-commands get an
+	// error reply and leave the display untouched.
+	switch (value) {
+		case META_GET_INFO:
+			parser_state = HostParserState::Idle;
+			reply_info();
+			break;
+		case META_GET_CAPS:
+			parser_state = HostParserState::Idle;
+			reply_caps();
+			break;
+		case META_SET_STREAMING_MODE:
+			parser_state = HostParserState::MetaStreamingMode;
+			break;
+		case META_SET_BAUD:
+			parser_state = HostParserState::MetaSetBaud;
+			break;
+		case META_CONFIRM_BAUD:
+			handle_confirm_baud();
+			break;
+		case META_SET_FLOW_CONTROL:
+			parser_state = HostParserState::MetaFlowControl;
+			break;
+#if ENABLE_REGION_OPS
+		case META_WRITE_REGION:
+			region_framed = false;
+			parser_state = HostParserState::MetaRegionRow;
+			break;
+		case META_FRAMED_REGION:
+			region_framed = true;
+			region_crc = 0;
+			parser_state = HostParserState::MetaFramedSequence;
+			break;
+		case META_FRAME_UPDATE:
+			begin_frame_update();
+			break;
+#endif
+		default:
+			parser_state = HostParserState::Idle;
+			begin_meta_reply();
+			HostSerial.println(F("err=unknown_cmd"));
+			break;
+	}
+}
+
+static void handle_streaming_mode_byte(uint8_t value) {
+	// Unknown non-zero values keep meaning StreamingSafe, as before Adaptive.
+	const uint8_t normalized = value == STREAMING_MODE_IMMEDIATE  ? STREAMING_MODE_IMMEDIATE
+	                           : value == STREAMING_MODE_ADAPTIVE ? STREAMING_MODE_ADAPTIVE
+	                                                              : STREAMING_MODE_SAFE;
+	if (streaming_mode != normalized) {
+		streaming_mode = normalized;
+		apply_streaming_mode(true);
+	}
+	parser_state = HostParserState::Idle;
+}
+
+static void handle_host_byte(uint8_t value) {
+	switch (parser_state) {
+		case HostParserState::Idle:
+			if (value == 0xFC) {
+#if USE_COMMAND_TRANSLATOR
+				// Meta commands may switch modes or reply; land batched text first.
+				command_translator.flushSpan();
+#endif
+				parser_state = HostParserState::Meta;
+			} else if (value == 0xFE) {
+				parser_state = HostParserState::Command;
+			} else if (value == 0xFD) {
+				parser_state = HostParserState::Backlight;
+			} else {
 				// By default we write to the LCD
-#if DISPLAY_BACKEND == HD44780
-				display.write(cmd);
+#if !USE_COMMAND_TRANSLATOR
+				display.write(value);
 #else
-				if (!command_translator.handleData(cmd)) {
-					display.write(cmd);
+				if (!command_translator.handleData(value)) {
+					display.write(value);
 				}
 #endif
-				break;
+			}
+			break;
+		case HostParserState::Command:
+#if !USE_COMMAND_TRANSLATOR
+			display.command(value);
+#else
+			command_translator.handleCommand(value);
+#endif
+			parser_state = HostParserState::Idle;
+			break;
+		case HostParserState::Backlight:
+#if DISPLAY_BACKEND == HD44780
+			display.setBacklight(value);
+#else
+			backlight_level = value;
+			backlight_pending = true;
+#endif
+			parser_state = HostParserState::Idle;
+			break;
+		case HostParserState::Meta:
+			handle_meta_byte(value);
+			break;
+		case HostParserState::MetaStreamingMode:
+			handle_streaming_mode_byte(value);
+			break;
+		case HostParserState::MetaSetBaud:
+			handle_set_baud_byte(value);
+			break;
+		case HostParserState::MetaFlowControl:
+			parser_state = HostParserState::Idle;
+			set_flow_control(value != 0);
+			break;
+#if ENABLE_REGION_OPS
+		case HostParserState::MetaFramedSequence:
+		case HostParserState::MetaRegionRow:
+		case HostParserState::MetaRegionColumn:
+		case HostParserState::MetaRegionLength:
+		case HostParserState::MetaRegionData:
+			handle_region_byte(value);
+			break;
+		case HostParserState::MetaFramedCrc:
+			handle_framed_crc_byte(value);
+			break;
+		case HostParserState::MetaFrameOp:
+		case HostParserState::MetaFrameCopy:
+		case HostParserState::MetaFrameRepeat:
+			handle_frame_byte(value);
+			break;
+#else
+		default:
+			parser_state = HostParserState::Idle;
+			break;
+#endif
 	}
-	serviceDisplayIdleWork();
+}
+
+// Consume every byte currently buffered before yielding to idle work, so RX
+// servicing and display catch-up are scheduled from one place in `loop()`.
+static uint16_t drain_host_rx() {
+	uint16_t consumed = 0;
+	int value;
+	while ((value = HostSerial.read()) >= 0) {
+		if (!host_active) {
+			mark_host_active();
+		}
+		// Count freed ring space before parsing, so the byte that enables flow
+		// control is not itself returned as credit.
+		if (flow_control_enabled) {
+			++flow_credit_owed;
+		}
+		handle_host_byte(static_cast<uint8_t>(value));
+		++consumed;
+		// Refill mid-batch so a host honoring credit never stalls on a long drain.
+		if (flow_credit_owed >= FLOW_CREDIT_BATCH) {
+			send_flow_credit(flow_credit_owed);
+			flow_credit_owed = 0;
+		}
+		// Yield to the refresh scheduler on every tick; the budget it gets
+		// already accounts for the bytes still waiting in the ring.
+		if (RefreshTick.due()) {
+			break;
+		}
+	}
+	if (consumed == 0) {
+		return 0;
+	}
+#if USE_COMMAND_TRANSLATOR
+	command_translator.flushSpan();
+#endif
+	last_rx_micros = micros();
+#if ENABLE_SERIAL_DEBUG
+	rx_bytes_total = static_cast<uint16_t>(rx_bytes_total + consumed);
+	rx_bytes_since_boot = static_cast<uint16_t>(rx_bytes_since_boot + consumed);
+	// Always suppress debug logging while bytes are actively arriving.
+	// Otherwise a prior idle-triggered banner (e.g., after a short meta
+	// command) can leave logging enabled during the next burst and cause
+	// us to overrun RX again.
+	if (host_active) {
+		SerialDebug::setRuntimeEnabled(false);
+	}
+#endif
+	return consumed;
+}
+
+// Microseconds of display work the RX ring can absorb right now: the free
+// slots (less a reserve) times one byte's time on the wire (10 bits, 8-N-1).
+// A host streaming flat out fills exactly that much while we are busy.
+static uint32_t display_refresh_budget_us() {
+	const uint16_t free_slots = static_cast<uint16_t>(HostSerial.capacity() - HostSerial.available());
+	if (free_slots <= REFRESH_BUDGET_RESERVE_BYTES || HostSerial.baud() == 0) {
+		return 0;
+	}
+	const uint32_t byte_us = 10000000UL / HostSerial.baud();
+	return static_cast<uint32_t>(free_slots - REFRESH_BUDGET_RESERVE_BYTES) * byte_us;
+}
+
+// Adaptive streaming: write through while the ring stays shallow, shadow and
+// defer once the backlog reaches the high-water mark, and only go back once
+// it is under the low-water mark *and* the deferred sinks have caught up, so
+// switching back never strands dirty rows. Checked once per loop pass, which
+// the refresh tick bounds to about a millisecond even inside long drains.
+static void service_adaptive_streaming() {
+	if (streaming_mode != STREAMING_MODE_ADAPTIVE) {
+		return;
+	}
+	const int fill = HostSerial.available();
+	if (!adaptive_deferring) {
+		if (fill < adaptive_high_water) {
+			return;
+		}
+		adaptive_deferring = true;
+	} else {
+		// A high-water mark at or under LOW_WATER means no write-through row
+		// is safe at this baud; stay deferred.
+		if (fill > STREAMING_ADAPTIVE_LOW_WATER || adaptive_high_water <= STREAMING_ADAPTIVE_LOW_WATER ||
+		    displayRefreshPending()) {
+			return;
+		}
+		adaptive_deferring = false;
+	}
+	setDualQueueingEnabled(adaptive_deferring);
+#if ENABLE_SERIAL_DEBUG
+	++adaptive_switches;
+#endif
+}
+
+static void service_host_idle() {
+	service_baud_fallback();
+	service_flow_credit();
+#if ENABLE_REGION_OPS
+	service_framed_region_timeout();
+#endif
+#if ENABLE_SERIAL_DEBUG
+	// Host-active reporting is emitted from here so we still report even when
+	// the host stops sending bytes.
+	maybe_enable_serial_debug_when_idle();
+	maybe_emit_host_active_report();
+	maybe_emit_streaming_mode_report();
+#endif
+	// Frame-buffer / deferred-sink catch-up runs once per RefreshTick, in
+	// chunks sized to what the RX ring can absorb, so it keeps a fixed cadence
+	// whatever the shape of the host stream.
+	if (RefreshTick.take() != 0) {
+#if ENABLE_SERIAL_DEBUG
+		const uint16_t tick = RefreshTick.now();
+		const uint16_t gap = static_cast<uint16_t>(tick - refresh_last_dispatch_tick);
+		if (gap > refresh_max_gap_ticks) {
+			refresh_max_gap_ticks = gap;
+		}
+		refresh_last_dispatch_tick = tick;
+#endif
+		uint32_t budget_us = display_refresh_budget_us();
+#if DISPLAY_BACKEND != HD44780
+		if (backlight_pending && budget_us >= BACKLIGHT_APPLY_COST_US) {
+			service_pending_backlight();
+			budget_us -= BACKLIGHT_APPLY_COST_US;
+		}
+#endif
+		serviceDisplayRefresh(budget_us);
+	}
+	// Everything else only runs once the RX stream has been quiet long
+	// enough that we won't overflow the UART RX buffer. Running I2C/LCD
+	// work that cannot be chunked in the tiny gaps between bytes can block
+	// long enough to drop the tail of unpaced bursts.
+	if (!host_active || (micros() - last_rx_micros) > HOST_IDLE_BEFORE_LOG_US) {
+#if USE_COMMAND_TRANSLATOR
+		command_translator.flushPendingGlyph();
+		command_translator.flushViewport();
+#endif
+#if DISPLAY_BACKEND != HD44780
+		service_pending_backlight();
+#endif
+		serviceDisplayIdleWork();
+	}
+}
+
+void loop() {
+#if ENABLE_SERIAL_DEBUG
+	const uint32_t batch_start = micros();
+	const int backlog = HostSerial.available();
+#endif
+	service_adaptive_streaming();
+	const uint16_t consumed = drain_host_rx();
+#if ENABLE_SERIAL_DEBUG
+	if (consumed != 0 && SerialDebug::isRuntimeEnabled() &&
+	    (backlog >= SERIAL_BATCH_LOG_MIN_BACKLOG || (micros() - batch_start) > SERIAL_BATCH_LOG_THRESHOLD_US)) {
+		SerialDebug::printPrefix();
+		HostSerial.print(F("serial.batch bytes="));
+		HostSerial.print(consumed);
+		HostSerial.print(F(" backlog="));
+		HostSerial.print(backlog);
+		HostSerial.print(F(" us="));
+		HostSerial.println(micros() - batch_start);
+	}
+#else
+	(void)consumed;
+#endif
+	service_host_idle();
 }